@@ -1,3 +1,4 @@
+#include <chrono>
 #include <iostream>
 #include <string>
 
@@ -6,22 +7,87 @@
 
 auto main(const int argc, const char* argv[]) -> int
 {
-    sail::Instance instance{};
+    sail::InstanceOptions options {};
+    bool printHeapStatistics = false;
+    bool printDispatchStatistics = false;
+    bool validArguments = true;
 
-    if (argc > 2)
+    int first = 1;
+    for (; first < argc && std::string(argv[first]).starts_with("--"); first++)
     {
-        std::cout << "Usage: sail [script]" << std::endl;
+        std::string flag = argv[first];
+        if (flag == "--tree-walk")
+        {
+            options.mode = sail::ExecutionMode::eTreeWalk;
+        }
+        else if (flag == "--closures")
+        {
+            options.mode = sail::ExecutionMode::eClosures;
+        }
+        else if (flag == "--no-optimize")
+        {
+            options.optimize = false;
+        }
+        else if (flag == "--no-jit")
+        {
+            options.jit = false;
+        }
+        else if (flag.starts_with("--jit-threshold="))
+        {
+            options.jitThreshold = std::stoull(flag.substr(16));
+        }
+        else if (flag.starts_with("--jit-loop-threshold="))
+        {
+            options.jitLoopThreshold = std::stoull(flag.substr(21));
+        }
+        else if (flag.starts_with("--max-call-depth="))
+        {
+            options.maxCallDepth = std::stoull(flag.substr(17));
+        }
+        else if (flag == "--gc-stats")
+        {
+            printHeapStatistics = true;
+        }
+        else if (flag == "--dispatch-stats")
+        {
+            printDispatchStatistics = true;
+        }
+        else if (flag.starts_with("--gc-budget="))
+        {
+            options.gcSliceBudget = std::chrono::microseconds(std::stoll(flag.substr(12)));
+        }
+        else
+        {
+            validArguments = false;
+        }
+    }
+
+    if (!validArguments || argc - first > 1)
+    {
+        std::cout << "Usage: sail [--tree-walk] [--closures] [--no-optimize] [--no-jit] [--jit-threshold=<calls>] [--jit-loop-threshold=<iterations>] [--max-call-depth=<calls>] [--gc-stats] [--dispatch-stats] [--gc-budget=<microseconds>] [script]" << std::endl;
         return EXIT_FAILURE;
     }
 
-    if (argc == 2)
+    sail::Instance instance {options};
+
+    if (argc - first == 1)
     {
-        instance.runFile(argv[1]);
+        instance.runFile(argv[first]);
     }
     else
     {
         instance.runPrompt();
     }
 
+    if (printHeapStatistics)
+    {
+        std::cerr << instance.heapStatistics() << std::endl;
+    }
+
+    if (printDispatchStatistics)
+    {
+        std::cerr << instance.dispatchStatistics() << std::endl;
+    }
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Bytecode/OpCode.h"
+#include "Bytecode/Value.h"
+
+namespace sail::Bytecode
+{
+    struct Chunk
+    {
+        std::vector<uint8_t> code;
+        std::vector<size_t> lines;
+        std::vector<Value> constants;
+
+        void write(uint8_t byte, size_t line);
+        void write(OpCode opCode, size_t line);
+        auto addConstant(Value value) -> size_t;
+        // Size of the instruction starting at offset, including its operands.
+        auto instructionLength(size_t offset) const -> size_t;
+    };
+}  // namespace sail::Bytecode
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sail::Bytecode
+{
+    // Operands follow the opcode inline. Constant, global and jump operands are 16-bit big-endian,
+    // local, upvalue and argument-count operands are a single byte.
+    enum class OpCode : uint8_t
+    {
+        eConstant,  // [constant]
+        eNull,
+        eTrue,
+        eFalse,
+        ePop,
+
+        eGetLocal,  // [slot]
+        eSetLocal,  // [slot]
+        eGetGlobal,  // [global]
+        eDefineGlobal,  // [global]
+        eSetGlobal,  // [global]
+        eGetUpvalue,  // [upvalue]
+        eSetUpvalue,  // [upvalue]
+        eGetProperty,  // [name constant]
+        eSetProperty,  // [name constant]
+        eGetSuper,  // [name constant]
+
+        eEqual,
+        eNotEqual,
+        eGreater,
+        eGreaterEqual,
+        eLess,
+        eLessEqual,
+        eAdd,
+        eSubtract,
+        eMultiply,
+        eDivide,
+        eNot,
+        eNegate,
+
+        eJump,  // [offset]
+        eJumpIfFalse,  // [offset]
+        eLoop,  // [offset]
+
+        eCall,  // [argument count]
+        // Calls a closure in place of the running function, reusing its frame. Any other callee
+        // is called like eCall, for the eReturn (or, if the result is discarded, ePop) after it.
+        eTailCall,  // [argument count] [discards result]
+        eClosure,  // [function constant] then ([is local] [index]) per upvalue
+        eCloseUpvalue,
+        eReturn,
+
+        eClass,  // [name constant]
+        eInherit,
+        eMethod,  // [name constant]
+
+        // Superinstructions, only produced by fuseSuperinstructions().
+        eGetLocalConstant,  // [slot] [constant]: GetLocal, Constant
+        eIncrementLocal,  // [slot] [number constant]: GetLocal, Constant, Add, SetLocal, Pop
+        eSetLocalPop,  // [slot]: SetLocal, Pop
+        // Compare, JumpIfFalse, Pop. Jumps with false on the stack when the comparison fails.
+        eLessJumpIfFalse,  // [offset]
+        eGreaterJumpIfFalse,  // [offset]
+    };
+
+    inline constexpr size_t kOpCodeCount = static_cast<size_t>(OpCode::eGreaterJumpIfFalse) + 1;
+}  // namespace sail::Bytecode
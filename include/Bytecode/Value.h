@@ -0,0 +1,159 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+
+#include "Objects/Object.h"
+
+namespace sail::Bytecode
+{
+    enum class ValueType : uint8_t
+    {
+        eNull,
+        eBool,
+        eNumber,
+        eObject,
+    };
+
+    // The value representation used by the virtual machine. Numbers, booleans and null are stored
+    // inline; strings, functions, classes and instances are objects owned by the machine.
+    //
+    // With SAIL_NAN_BOXING every value is a single 64-bit word: doubles are stored as themselves,
+    // and everything else hides in the payload of a quiet NaN. Objects set the sign bit and keep
+    // their 48-bit address in the low bits; null, false and true use small tags. Without it the
+    // value is a tagged union, which is larger but makes no assumptions about pointer width.
+    class Value
+    {
+#ifdef SAIL_NAN_BOXING
+      public:
+        // Public so that machine code generated by the JitCompiler can test and build values.
+        static constexpr uint64_t kSignBit = 0x8000000000000000;
+        static constexpr uint64_t kQuietNan = 0x7ffc000000000000;
+
+        static constexpr uint64_t kTagNull = 1;
+        static constexpr uint64_t kTagFalse = 2;
+        static constexpr uint64_t kTagTrue = 3;
+
+        static constexpr uint64_t kNull = kQuietNan | kTagNull;
+        static constexpr uint64_t kFalse = kQuietNan | kTagFalse;
+        static constexpr uint64_t kTrue = kQuietNan | kTagTrue;
+
+        Value() = default;
+        Value(double number)  // NOLINT(google-explicit-constructor)
+            : _bits(std::bit_cast<uint64_t>(number))
+        {
+        }
+        Value(bool boolean)  // NOLINT(google-explicit-constructor)
+            : _bits(boolean ? kTrue : kFalse)
+        {
+        }
+        Value(Object* object)  // NOLINT(google-explicit-constructor)
+            : _bits(kSignBit | kQuietNan | reinterpret_cast<uintptr_t>(object))
+        {
+        }
+
+        auto type() const -> ValueType
+        {
+            if (isNumber())
+            {
+                return ValueType::eNumber;
+            }
+            if (isObject())
+            {
+                return ValueType::eObject;
+            }
+            return isNull() ? ValueType::eNull : ValueType::eBool;
+        }
+        auto isNull() const -> bool { return _bits == kNull; }
+        auto isBool() const -> bool { return (_bits | 1) == kTrue; }
+        auto isNumber() const -> bool { return (_bits & kQuietNan) != kQuietNan; }
+        auto isObject() const -> bool
+        {
+            return (_bits & (kQuietNan | kSignBit)) == (kQuietNan | kSignBit);
+        }
+        auto isObjectType(ObjectType type) const -> bool
+        {
+            return isObject() && asObject()->type == type;
+        }
+
+        auto asBool() const -> bool { return _bits == kTrue; }
+        auto asNumber() const -> double { return std::bit_cast<double>(_bits); }
+        auto asObject() const -> Object*
+        {
+            return reinterpret_cast<Object*>(
+                static_cast<uintptr_t>(_bits & ~(kSignBit | kQuietNan)));
+        }
+
+        template<typename T>
+        auto as() const -> T*
+        {
+            return static_cast<T*>(asObject());
+        }
+#else
+      public:
+        Value() = default;
+        Value(double number)  // NOLINT(google-explicit-constructor)
+            : _type(ValueType::eNumber)
+        {
+            _as.number = number;
+        }
+        Value(bool boolean)  // NOLINT(google-explicit-constructor)
+            : _type(ValueType::eBool)
+        {
+            _as.boolean = boolean;
+        }
+        Value(Object* object)  // NOLINT(google-explicit-constructor)
+            : _type(ValueType::eObject)
+        {
+            _as.object = object;
+        }
+
+        auto type() const -> ValueType { return _type; }
+        auto isNull() const -> bool { return _type == ValueType::eNull; }
+        auto isBool() const -> bool { return _type == ValueType::eBool; }
+        auto isNumber() const -> bool { return _type == ValueType::eNumber; }
+        auto isObject() const -> bool { return _type == ValueType::eObject; }
+        auto isObjectType(ObjectType type) const -> bool
+        {
+            return isObject() && _as.object->type == type;
+        }
+
+        auto asBool() const -> bool { return _as.boolean; }
+        auto asNumber() const -> double { return _as.number; }
+        auto asObject() const -> Object* { return _as.object; }
+
+        template<typename T>
+        auto as() const -> T*
+        {
+            return static_cast<T*>(_as.object);
+        }
+#endif
+
+        auto isTruthy() const -> bool;
+
+        // Implicitly converts the value to a number if possible, matching sail::Value::asNumber.
+        auto toNumber() const -> std::optional<double>;
+
+        auto operator==(const Value& other) const -> bool;
+        friend auto operator<<(std::ostream& ostr, const Value& value) -> std::ostream&;
+
+      private:
+#ifdef SAIL_NAN_BOXING
+        uint64_t _bits = kNull;
+#else
+        ValueType _type = ValueType::eNull;
+        union
+        {
+            bool boolean;
+            double number;
+            Object* object;
+        } _as {};
+#endif
+    };
+
+#ifdef SAIL_NAN_BOXING
+    static_assert(sizeof(Value) == sizeof(uint64_t));
+#endif
+}  // namespace sail::Bytecode
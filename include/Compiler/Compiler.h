@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Bytecode/Chunk.h"
+#include "Expressions/Expression.h"
+#include "Memory/HeapRoots.h"
+#include "Objects/Objects.h"
+#include "Resolver/Resolver.h"
+#include "Statements/Statements.h"
+
+namespace sail
+{
+    class VirtualMachine;
+
+    // Lowers a resolved program into bytecode for the VirtualMachine. The Resolver has already
+    // rejected invalid programs, so the compiler only tracks enough scope information to assign
+    // stack slots and upvalues.
+    class Compiler final
+        : public ExpressionVisitor
+        , public StatementVisitor
+        , public HeapRoots
+    {
+      public:
+        explicit Compiler(VirtualMachine& machine);
+
+        auto compile(std::vector<std::shared_ptr<Statement>>& statements) -> Objects::Function*;
+
+        // Functions under construction are not referenced by any constant table yet.
+        void markRoots(Heap& heap) override;
+
+      private:
+        struct Local
+        {
+            std::string name;
+            int depth;
+            bool isCaptured = false;
+        };
+
+        struct Upvalue
+        {
+            uint8_t index;
+            bool isLocal;
+        };
+
+        struct FunctionState
+        {
+            FunctionState* enclosing;
+            Objects::Function* function;
+            FunctionType type;
+            std::vector<Local> locals;
+            std::vector<Upvalue> upvalues;
+            int scopeDepth = 0;
+        };
+
+        struct ClassState
+        {
+            ClassState* enclosing;
+            bool hasSuperclass = false;
+        };
+
+        void compile(std::shared_ptr<Statement>& statement);
+        void compile(std::shared_ptr<Expression>& expression);
+
+        void visitBlockStatement(Statements::Block& blockStatement,
+                                 std::shared_ptr<Statement>& shared) override;
+        void visitClassStatement(Statements::Class& classStatement,
+                                 std::shared_ptr<Statement>& shared) override;
+        void visitExpressionStatement(Statements::Expression& expressionStatement,
+                                      std::shared_ptr<Statement>& shared) override;
+        void visitFunctionStatement(Statements::Function& functionStatement,
+                                    std::shared_ptr<Statement>& shared) override;
+        void visitIfStatement(Statements::If& ifStatement,
+                              std::shared_ptr<Statement>& shared) override;
+        void visitReturnStatement(Statements::Return& returnStatement,
+                                  std::shared_ptr<Statement>& shared) override;
+        void visitVariableStatement(Statements::Variable& variableStatement,
+                                    std::shared_ptr<Statement>& shared) override;
+        void visitWhileStatement(Statements::While& whileStatement,
+                                 std::shared_ptr<Statement>& shared) override;
+
+        void visitAssignmentExpression(Expressions::Assignment& assignmentExpression,
+                                       std::shared_ptr<Expression>& shared) override;
+        void visitBinaryExpression(Expressions::Binary& binaryExpression,
+                                   std::shared_ptr<Expression>& shared) override;
+        void visitCallExpression(Expressions::Call& callExpression,
+                                 std::shared_ptr<Expression>& shared) override;
+        void visitGetExpression(Expressions::Get& getExpression,
+                                std::shared_ptr<Expression>& shared) override;
+        void visitGroupingExpression(Expressions::Grouping& groupingExpression,
+                                     std::shared_ptr<Expression>& shared) override;
+        void visitLiteralExpression(Expressions::Literal& literalExpression,
+                                    std::shared_ptr<Expression>& shared) override;
+        void visitLogicalExpression(Expressions::Logical& logicalExpression,
+                                    std::shared_ptr<Expression>& shared) override;
+        void visitSetExpression(Expressions::Set& setExpression,
+                                std::shared_ptr<Expression>& shared) override;
+        void visitSuperExpression(Expressions::Super& superExpression,
+                                  std::shared_ptr<Expression>& shared) override;
+        void visitThisExpression(Expressions::This& thisExpression,
+                                 std::shared_ptr<Expression>& shared) override;
+        void visitUnaryExpression(Expressions::Unary& unaryExpression,
+                                  std::shared_ptr<Expression>& shared) override;
+        void visitVariableExpression(Expressions::Variable& variableExpression,
+                                     std::shared_ptr<Expression>& shared) override;
+
+        auto chunk() -> Bytecode::Chunk&;
+        void emit(Bytecode::OpCode opCode);
+        void emitByte(uint8_t byte);
+        void emitShort(uint16_t value);
+        void emitConstant(Bytecode::Value value);
+        auto emitJump(Bytecode::OpCode opCode) -> size_t;
+        void patchJump(size_t offset);
+        void emitLoop(size_t loopStart);
+        void emitReturn();
+        // Compiles the callee and arguments of a call, for eCall or eTailCall to follow.
+        void compileCall(Expressions::Call& callExpression);
+        void emitTailCall(Expressions::Call& callExpression, bool discardResult);
+
+        auto makeConstant(Bytecode::Value value) -> uint16_t;
+        auto identifierConstant(const std::string& name) -> uint16_t;
+
+        void beginFunction(FunctionState& state, FunctionType type, const std::string& name);
+        auto endFunction() -> Objects::Function*;
+        void function(Statements::Function& functionStatement, FunctionType type);
+
+        void beginScope();
+        void endScope();
+        void addLocal(const std::string& name);
+        void declareVariable(const std::string& name);
+        void defineVariable(const std::string& name);
+        void namedVariable(const std::string& name, bool assign);
+
+        auto resolveLocal(FunctionState& state, const std::string& name) -> int;
+        auto resolveUpvalue(FunctionState& state, const std::string& name) -> int;
+        auto addUpvalue(FunctionState& state, uint8_t index, bool isLocal) -> int;
+
+        VirtualMachine& _machine;
+        FunctionState* _current = nullptr;
+        ClassState* _currentClass = nullptr;
+        size_t _line = 0;
+    };
+}  // namespace sail
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Bytecode/Chunk.h"
+
+namespace sail
+{
+    // Rewrites the most frequently dispatched instruction sequences of a finished chunk into the
+    // superinstructions at the end of OpCode. The set was picked from --dispatch-stats counts of
+    // the scripts in tests/sail-lang. Sequences with a jump landing inside them are left alone,
+    // and every jump is retargeted to the rewritten code.
+    void fuseSuperinstructions(Bytecode::Chunk& chunk);
+}  // namespace sail
@@ -6,6 +6,8 @@
 
 namespace sail
 {
+    // Variables looked up by name. Only globals live in an environment; locals live in the
+    // Interpreter's frames, in the slots assigned by the Resolver.
     class Environment
     {
       public:
@@ -14,21 +16,16 @@ namespace sail
 
         auto get(const std::string& name) -> Value&;
         auto get(const Token& name) -> Value&;
-        auto getAt(size_t distance, const std::string& name) -> Value&;
-        auto getAt(size_t distance, const Token& name) -> Value&;
         void define(const std::string& name, const Value& value);
         void define(const Token& name, const Value& value);
         void assign(const Token& name, const Value& value);
-        void assignAt(size_t distance, const Token& name, const Value& value);
 
         auto enclosing() const -> std::shared_ptr<Environment> const& { return _enclosing; }
 
         void reset();
 
       private:
-        auto ancestor(size_t distance) -> Environment*;
-
         ankerl::unordered_dense::map<std::string, Value> _values {};
         std::shared_ptr<Environment> _enclosing {};
     };
-}  // namespace sail
\ No newline at end of file
+}  // namespace sail
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <exception>
+#include <string>
+
+namespace sail
+{
+    class CompilerError : public std::exception
+    {
+      public:
+        CompilerError(const std::string& message, size_t line);
+
+        auto what() const noexcept -> const char* override;
+
+      private:
+        std::string _message;
+    };
+}  // namespace sail
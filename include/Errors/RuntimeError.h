@@ -8,6 +8,7 @@ namespace sail
     {
       public:
         RuntimeError(const Token& token, const std::string& message);
+        RuntimeError(size_t line, const std::string& message);
 
         auto what() const noexcept -> const char* override;
 
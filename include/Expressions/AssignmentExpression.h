@@ -2,6 +2,7 @@
 
 #include <memory>
 
+#include "Binding.h"
 #include "Expression.h"
 
 namespace sail::Expressions
@@ -10,6 +11,7 @@ namespace sail::Expressions
     {
         Token name;
         std::shared_ptr<Expression> value;
+        Binding binding;
 
         void accept(ExpressionVisitor& visitor, std::shared_ptr<Expression>& shared) override
         {
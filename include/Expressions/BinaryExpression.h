@@ -1,16 +1,29 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 
 #include "Expression.h"
 
 namespace sail::Expressions
 {
+    // Operand types a binary operator has seen, recorded by the Interpreter at each site.
+    enum class OperandTypes : uint8_t
+    {
+        // The site has not been evaluated yet.
+        eNone,
+        // Both operands were numbers every time, so the site takes the number path first.
+        eNumbers,
+        // Some evaluation had another type. Sites never go back to eNumbers.
+        eMixed,
+    };
+
     struct Binary final : public Expression
     {
         std::shared_ptr<Expression> left;
         Token op;
         std::shared_ptr<Expression> right;
+        OperandTypes operandTypes = OperandTypes::eNone;
 
         void accept(ExpressionVisitor& visitor, std::shared_ptr<Expression>& shared) override
         {
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+namespace sail::Expressions
+{
+    enum class BindingKind
+    {
+        // Looked up by name in the global environment.
+        eGlobal,
+        // A slot in the frame of the function currently running.
+        eLocal,
+        // An index into the upvalues captured by the closure currently running.
+        eUpvalue,
+    };
+
+    // Where a name lives at runtime, filled in by the Resolver. References the Resolver could not
+    // find in any enclosing scope stay global.
+    struct Binding
+    {
+        BindingKind kind = BindingKind::eGlobal;
+        size_t slot = 0;
+    };
+}  // namespace sail::Expressions
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "Expression.h"
+#include "GetExpression.h"
 
 namespace sail::Expressions
 {
@@ -12,6 +13,9 @@ namespace sail::Expressions
         std::shared_ptr<Expression> callee;
         Token paren;
         std::vector<std::shared_ptr<Expression>> arguments;
+        // Set by the Resolver when the callee is a property access, so that calling a method does
+        // not have to create a bound method first. Points into callee.
+        Get* property = nullptr;
 
         void accept(ExpressionVisitor& visitor, std::shared_ptr<Expression>& shared) override
         {
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Expression.h"
+#include "InlineCache.h"
+#include "Resolver/Selectors.h"
 
 namespace sail::Expressions
 {
@@ -8,6 +10,10 @@ namespace sail::Expressions
     {
         std::shared_ptr<Expression> object;
         Token name;
+        // Assigned by the Interpreter once a class declares a method with the name, and used when
+        // the name turns out to refer to a method.
+        Selector selector = Selectors::kNone;
+        PropertyCache cache;
 
         void accept(ExpressionVisitor& visitor, std::shared_ptr<Expression>& shared) override
         {
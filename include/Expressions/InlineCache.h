@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+
+namespace sail::Types
+{
+    class Class;
+    class Function;
+    class Shape;
+}  // namespace sail::Types
+
+namespace sail::Expressions
+{
+    // What a property access resolved to for instances of one shape. Shapes belong to a single
+    // class, so the shape also decides which method a name refers to.
+    //
+    // The entry lives in the syntax tree of a method, which its class owns, so it must not own
+    // the class or its methods in turn.
+    struct PropertyCacheEntry
+    {
+        const Types::Shape* shape = nullptr;
+        // The class owning the shape. Once it is gone, the shape's address can be reused.
+        std::weak_ptr<Types::Class> klass {};
+        size_t slot = 0;
+        // Set when the name refers to a method rather than a field. It lives as long as the class.
+        std::weak_ptr<Types::Function> method {};
+        // Set when a store adds the field, to the shape the instance moves to.
+        Types::Shape* transition = nullptr;
+    };
+
+    // Per-site cache of property lookups, filled in by the Interpreter. It remembers up to
+    // kEntries shapes. At sites that see more than that, new shapes replace the oldest entries.
+    struct PropertyCache
+    {
+        static constexpr size_t kEntries = 4;
+
+        auto find(const Types::Shape* shape) -> const PropertyCacheEntry*
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (entries[i].shape == shape && !entries[i].klass.expired())
+                {
+                    return &entries[i];
+                }
+            }
+            return nullptr;
+        }
+
+        auto add(PropertyCacheEntry entry) -> const PropertyCacheEntry&
+        {
+            PropertyCacheEntry& added = entries[next];
+            added = std::move(entry);
+            next = (next + 1) % kEntries;
+            count = std::min(count + 1, kEntries);
+            return added;
+        }
+
+        std::array<PropertyCacheEntry, kEntries> entries;
+        size_t count = 0;
+        size_t next = 0;
+    };
+}  // namespace sail::Expressions
@@ -1,12 +1,15 @@
 #pragma once
 
 #include "Expression.h"
+#include "Types/Value.h"
 
 namespace sail::Expressions
 {
     struct Literal final : public Expression
     {
         LiteralType literal;
+        // The literal converted once to the value the tree-walker produces for it.
+        Value value;
 
         void accept(ExpressionVisitor& visitor, std::shared_ptr<Expression>& shared) override
         {
@@ -15,6 +18,8 @@ namespace sail::Expressions
 
         explicit Literal(LiteralType literal)
             : literal(std::move(literal))
+            , value(std::visit([](const auto& constant) -> Value { return constant; },
+                               this->literal))
         {
         }
     };
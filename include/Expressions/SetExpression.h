@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Expression.h"
+#include "InlineCache.h"
 
 namespace sail::Expressions
 {
@@ -9,6 +10,7 @@ namespace sail::Expressions
         std::shared_ptr<Expression> object;
         Token name;
         std::shared_ptr<Expression> value;
+        PropertyCache cache;
 
         void accept(ExpressionVisitor& visitor, std::shared_ptr<Expression>& shared) override
         {
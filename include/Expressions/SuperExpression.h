@@ -1,6 +1,8 @@
 #pragma once
 
+#include "Binding.h"
 #include "Expression.h"
+#include "Resolver/Selectors.h"
 
 namespace sail::Expressions
 {
@@ -8,6 +10,10 @@ namespace sail::Expressions
     {
         Token keyword;
         Token method;
+        Binding binding;
+        Binding thisBinding;
+        // Assigned by the Interpreter once a class declares a method with the name.
+        Selector selector = Selectors::kNone;
 
         void accept(ExpressionVisitor& visitor, std::shared_ptr<Expression>& shared) override
         {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Binding.h"
 #include "Expression.h"
 
 namespace sail::Expressions
@@ -7,6 +8,7 @@ namespace sail::Expressions
     struct Variable final : public Expression
     {
         Token name;
+        Binding binding;
 
         void accept(ExpressionVisitor& visitor, std::shared_ptr<Expression>& shared) override
         {
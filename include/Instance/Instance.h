@@ -1,24 +1,73 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <string>
 
+#include "Memory/Heap.h"
+#include "Resolver/Selectors.h"
+#include "VirtualMachine/DispatchStatistics.h"
+
 namespace sail
 {
     class Interpreter;
+    class VirtualMachine;
+
+    enum class ExecutionMode
+    {
+        // Compiles to bytecode and runs it on the VirtualMachine.
+        eBytecode,
+        // Walks the resolved syntax tree directly. Kept as the reference implementation.
+        eTreeWalk,
+        // Runs the resolved syntax tree on the tree-walker after turning it into closures.
+        eClosures,
+    };
+
+    struct InstanceOptions
+    {
+        ExecutionMode mode = ExecutionMode::eBytecode;
+        // Longest the bytecode machine may pause for one slice of an incremental collection. Zero
+        // collects the whole old generation in a single stop-the-world pause.
+        std::chrono::microseconds gcSliceBudget {0};
+        // Folds constants and simplifies the resolved tree before either engine sees it.
+        bool optimize = true;
+        // Lets the bytecode machine compile a function to machine code once it has been called
+        // jitThreshold times, or once its loops have jumped back jitLoopThreshold times. Ignored
+        // where the JitCompiler is not supported.
+        bool jit = true;
+        size_t jitThreshold = 1000;
+        size_t jitLoopThreshold = 10000;
+        // Deepest nesting of calls allowed before a call raises a RuntimeError. The bytecode
+        // machine reserves address space for this depth, but only uses memory for the depth its
+        // calls actually reach. The tree-walker recurses on the native stack for every call, so
+        // it also raises the error once the thread's stack is nearly used up.
+        size_t maxCallDepth = 1024;
+    };
 
     class Instance
     {
       public:
-        Instance();
+        explicit Instance(InstanceOptions options = {});
         ~Instance();
 
         void runFile(const std::string& path);
         void runPrompt();
 
+        // Statistics of the bytecode machine's heap. The tree-walker manages its values through
+        // shared ownership and does not report any.
+        auto heapStatistics() const -> const HeapStatistics&;
+        auto dispatchStatistics() const -> const DispatchStatistics&;
+
       private:
         void run(const std::string& source);
 
-        Interpreter* _interpreter;
+        InstanceOptions _options;
+        // Numbers the methods of every program the instance runs, which is what lets classes and
+        // call sites from different runs share method tables.
+        Selectors _selectors;
+        // Only the one running the mode's programs is built.
+        Interpreter* _interpreter = nullptr;
+        VirtualMachine* _machine = nullptr;
     };
-}  // namespace sail
\ No newline at end of file
+}  // namespace sail
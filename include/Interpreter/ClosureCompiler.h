@@ -0,0 +1,113 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Expressions/Expression.h"
+#include "Interpreter/CompiledTree.h"
+#include "Interpreter/Interpreter.h"
+#include "Statements/Statements.h"
+
+namespace sail
+{
+    // Turns the resolved syntax tree into a tree of closures for the Interpreter to run, as a
+    // middle ground between walking the tree and compiling it to bytecode. Every node is visited
+    // once, up front, to pick the closure specialized for it: the operator of a binary expression,
+    // the kind of binding of a variable and so on. Running the result then skips the visitors'
+    // double dispatch and hands values back directly instead of through the Interpreter.
+    //
+    // The closures refer to the nodes they were built from, which the statements passed in and the
+    // functions they declare keep alive. Function bodies are compiled along with the declaration.
+    class ClosureCompiler
+        : public ExpressionVisitor
+        , public StatementVisitor
+    {
+      public:
+        ClosureCompiler() = default;
+
+        auto compile(std::vector<std::shared_ptr<Statement>>& statements) -> CompiledStatement;
+
+      private:
+        auto compile(std::shared_ptr<Statement>& statement) -> CompiledStatement;
+        auto compile(std::shared_ptr<Expression>& expression) -> CompiledExpression;
+        auto compileAll(std::vector<std::shared_ptr<Expression>>& expressions)
+            -> std::vector<CompiledExpression>;
+        auto compileBody(Statements::Function& functionStatement)
+            -> std::shared_ptr<const CompiledStatement>;
+
+        void visitBlockStatement(Statements::Block& blockStatement,
+                                 std::shared_ptr<Statement>& shared) override;
+        void visitClassStatement(Statements::Class& classStatement,
+                                 std::shared_ptr<Statement>& shared) override;
+        void visitExpressionStatement(Statements::Expression& expressionStatement,
+                                      std::shared_ptr<Statement>& shared) override;
+        void visitFunctionStatement(Statements::Function& functionStatement,
+                                    std::shared_ptr<Statement>& shared) override;
+        void visitIfStatement(Statements::If& ifStatement,
+                              std::shared_ptr<Statement>& shared) override;
+        void visitReturnStatement(Statements::Return& returnStatement,
+                                  std::shared_ptr<Statement>& shared) override;
+        void visitVariableStatement(Statements::Variable& variableStatement,
+                                    std::shared_ptr<Statement>& shared) override;
+        void visitWhileStatement(Statements::While& whileStatement,
+                                 std::shared_ptr<Statement>& shared) override;
+
+        void visitAssignmentExpression(Expressions::Assignment& assignmentExpression,
+                                       std::shared_ptr<Expression>& shared) override;
+        void visitBinaryExpression(Expressions::Binary& binaryExpression,
+                                   std::shared_ptr<Expression>& shared) override;
+        void visitCallExpression(Expressions::Call& callExpression,
+                                 std::shared_ptr<Expression>& shared) override;
+        void visitGetExpression(Expressions::Get& getExpression,
+                                std::shared_ptr<Expression>& shared) override;
+        void visitGroupingExpression(Expressions::Grouping& groupingExpression,
+                                     std::shared_ptr<Expression>& shared) override;
+        void visitLiteralExpression(Expressions::Literal& literalExpression,
+                                    std::shared_ptr<Expression>& shared) override;
+        void visitLogicalExpression(Expressions::Logical& logicalExpression,
+                                    std::shared_ptr<Expression>& shared) override;
+        void visitSetExpression(Expressions::Set& setExpression,
+                                std::shared_ptr<Expression>& shared) override;
+        void visitSuperExpression(Expressions::Super& superExpression,
+                                  std::shared_ptr<Expression>& shared) override;
+        void visitThisExpression(Expressions::This& thisExpression,
+                                 std::shared_ptr<Expression>& shared) override;
+        void visitUnaryExpression(Expressions::Unary& unaryExpression,
+                                  std::shared_ptr<Expression>& shared) override;
+        void visitVariableExpression(Expressions::Variable& variableExpression,
+                                     std::shared_ptr<Expression>& shared) override;
+
+        // Reads and writes of a variable, specialized for the kind of its binding.
+        static auto load(const Token& name, const Expressions::Binding& binding)
+            -> CompiledExpression;
+        static auto declare(const Token& name, const Expressions::Binding& binding)
+            -> std::function<void(Interpreter&, Value)>;
+
+        // Evaluates the arguments onto the value stack like Interpreter::withArguments, then calls
+        // the callee with them.
+        static auto callValue(Interpreter& interpreter,
+                              const Expressions::Call& callExpression,
+                              const std::vector<CompiledExpression>& arguments,
+                              const Value& callee) -> Value;
+        // Statements ending their function with a call, run by Interpreter::callFunction in the
+        // caller's frame when the callee is an interpreted function.
+        auto compileTailCall(Expressions::Call& callExpression, bool discardResult)
+            -> CompiledStatement;
+        static auto tailCall(Interpreter& interpreter,
+                             const Expressions::Call& callExpression,
+                             const std::vector<CompiledExpression>& arguments,
+                             Interpreter::TailCall target) -> Completion;
+        // Finishes a tail call the callee could not take over, with the result of calling it.
+        static auto completeCall(Interpreter& interpreter, Value result, bool discardResult)
+            -> Completion;
+        template<typename Call>
+        static auto withArguments(Interpreter& interpreter,
+                                  const std::vector<CompiledExpression>& arguments,
+                                  Call&& call) -> Value;
+
+        // Result of the last visit.
+        CompiledStatement _statement;
+        CompiledExpression _expression;
+    };
+}  // namespace sail
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <functional>
+
+namespace sail
+{
+    class Interpreter;
+    struct Value;
+
+    // How a statement finished executing. A return propagates outwards through the enclosing
+    // blocks and loops until the function call that started them consumes it.
+    enum class Completion
+    {
+        eNormal,
+        eReturn,
+    };
+
+    // Expressions and statements the ClosureCompiler has specialized ahead of time: operators are
+    // chosen, variables resolved to their slots and literals boxed, so running them takes a single
+    // indirect call per node instead of going through the visitors.
+    using CompiledExpression = std::function<Value(Interpreter&)>;
+    using CompiledStatement = std::function<Completion(Interpreter&)>;
+}  // namespace sail
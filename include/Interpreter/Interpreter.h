@@ -1,47 +1,63 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "Environment/Environment.h"
 #include "Expressions/Expressions.h"
+#include "Interpreter/CompiledTree.h"
+#include "Interpreter/NativeStack.h"
 #include "Statements/Statements.h"
 #include "Types/Types.h"
+#include "Types/UpvalueType.h"
 
 namespace sail
 {
-    class Return : public std::exception
-    {
-      public:
-        explicit Return(Value value)
-            : _value(std::move(value))
-        {
-        }
-
-        auto value() const -> Value { return _value; }
-
-      private:
-        Value _value;
-    };
-
     class Interpreter final
         : public ExpressionVisitor
         , public StatementVisitor
     {
       public:
-        Interpreter();
+        static constexpr size_t kDefaultMaxCallDepth = 1024;
 
-        void execute(std::shared_ptr<Statement>& statement);
-        void interpret(std::vector<std::shared_ptr<Statement>>& statements);
+        // Runs programs whose methods were numbered in the given selectors. Every call recurses on
+        // the native stack. Calls nested deeper than maxCallDepth, or made once the running
+        // thread's stack is nearly used up, raise a RuntimeError instead.
+        explicit Interpreter(Selectors& selectors, size_t maxCallDepth = kDefaultMaxCallDepth);
 
-        void executeBlock(std::vector<std::shared_ptr<Statement>>& statements,
-                          std::shared_ptr<Environment> environment);
+        auto execute(std::shared_ptr<Statement>& statement) -> Completion;
+        void interpret(std::vector<std::shared_ptr<Statement>>& statements);
+        // Runs a program the ClosureCompiler built from resolved top-level statements.
+        void interpret(const CompiledStatement& program);
 
-        void resolve(const std::shared_ptr<Expression>& expression, size_t depth);
+        // Runs an interpreted function. The arguments have to be the top of the value stack,
+        // where they become the first slots of the function's frame. Methods are also given the
+        // instance they were invoked on.
+        auto callFunction(Types::Function& function,
+                          std::span<Value> arguments,
+                          std::shared_ptr<Types::Instance> instance) -> Value;
 
-        auto getCurrentEnvironment() const -> std::shared_ptr<Environment> { return _environment; }
+        // Clears a pending return and yields the returned value.
+        auto takeReturnValue() -> Value;
 
       private:
+        // Builds closures working directly on the frames below.
+        friend class ClosureCompiler;
+
+        static constexpr size_t kInitialStackSize = 1024;
+
+        // A call in tail position, which callFunction runs in place of the function making it
+        // once that function's statements have unwound. Its arguments are the top of the stack.
+        struct TailCall
+        {
+            std::shared_ptr<Types::Function> function {};
+            std::shared_ptr<Types::Instance> instance {};
+            // Set for calls in expression statements, whose caller returns null instead of their
+            // result.
+            bool discardResult = false;
+        };
+
         auto evaluate(std::shared_ptr<Expression>& expression) -> Value&;
 
         void visitBlockStatement(Statements::Block& blockStatement,
@@ -86,13 +102,64 @@ namespace sail
         void visitVariableExpression(Expressions::Variable& variableExpression,
                                      std::shared_ptr<Expression>& shared) override;
 
-        auto lookupVariable(const Token& name, const std::shared_ptr<Expression>& expression)
-            -> Value;
-
+        // Arithmetic and comparisons once both operands are numbers.
+        void applyNumberOperator(const Token& op, double left, double right);
+        auto lookupVariable(const Token& name, const Expressions::Binding& binding) -> Value;
+        void declare(const Token& name, const Expressions::Binding& binding, const Value& value);
+        auto executeStatements(std::vector<std::shared_ptr<Statement>>& statements) -> Completion;
+
+        auto captureUpvalues(const Statements::Function& declaration)
+            -> std::vector<std::shared_ptr<Types::Upvalue>>;
+        auto captureUpvalue(size_t slot) -> std::shared_ptr<Types::Upvalue>;
+        // Moves every variable at or above the slot that a closure captured into its upvalue.
+        void closeUpvalues(size_t fromSlot);
+        auto upvalue(size_t index) -> Value&;
+
+        void invoke(Expressions::Call& callExpression, Expressions::Get& property);
+        void callValue(Expressions::Call& callExpression, const Value& callee);
+        // Evaluates the arguments onto the value stack and hands them to the call as a span.
+        template<typename Call>
+        void withArguments(Expressions::Call& callExpression, Call&& call);
+        static void checkArity(const Expressions::Call& callExpression,
+                               size_t arity,
+                               size_t argumentCount);
+        // Evaluates a call the Resolver found in tail position. Interpreted functions are left to
+        // callFunction; anything else is called right away.
+        auto executeTailCall(Expressions::Call& callExpression, bool discardResult) -> Completion;
+        // Picks the interpreted function and instance a callee runs, if it is one.
+        static void tailCallTarget(const Value& callee, TailCall& tailCall);
+        // Hands the call whose arguments were pushed from the base over to callFunction by making
+        // the running statements return.
+        auto scheduleTailCall(const Expressions::Call& callExpression,
+                              TailCall tailCall,
+                              size_t argumentsBase) -> Completion;
+        auto lookupProperty(Expressions::Get& getExpression, Types::Instance& receiver)
+            -> const Expressions::PropertyCacheEntry&;
+        // Numbers the site's method name on first use, as the class declaring the method may be
+        // resolved after the site. Names no class has declared stay unnumbered.
+        auto selectorOf(Selector& selector, const std::string& name) const -> Selector;
+
+        Selectors& _selectors;
         std::shared_ptr<Environment> _globalEnvironment;
-        std::shared_ptr<Environment> _environment;
-        ankerl::unordered_dense::map<std::shared_ptr<Expression>, size_t> _locals;
 
+        // Frames of the running functions followed by the arguments being evaluated for the next
+        // call. Top-level blocks use a frame starting at the bottom of the stack.
+        std::vector<Value> _stack;
+        size_t _frameBase = 0;
+        Types::Function* _function = nullptr;
+        // Calls currently running; tail calls reuse their caller's.
+        size_t _callDepth = 0;
+        size_t _maxCallDepth;
+        // Stack of the thread running the program, taken when it starts.
+        NativeStack _nativeStack;
+        // Upvalues still referring to a stack slot, ordered by slot.
+        std::vector<std::shared_ptr<Types::Upvalue>> _openUpvalues;
+
+        // Result of the last evaluated expression, and the returned value while a return is
+        // propagating.
         Value _returnValue;
+        Completion _completion = Completion::eNormal;
+        // Set while a return is propagating for a call in tail position.
+        TailCall _tailCall;
     };
 }  // namespace sail
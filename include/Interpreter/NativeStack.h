@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sail
+{
+    // Lower bound of a thread's native stack, for code recursing on it to stop with an error
+    // before the thread runs out. Stacks are assumed to grow down.
+    class NativeStack
+    {
+      public:
+        // Left unused below the bound, for the frames between two checks and for raising the error.
+        static constexpr size_t kHeadroom = 64 * 1024;
+
+        NativeStack() = default;
+
+        // Bounds of the calling thread's stack. Where they cannot be queried, it never runs out.
+        static auto current() -> NativeStack;
+
+        auto exhausted() const -> bool
+        {
+            char marker = 0;
+            return reinterpret_cast<uintptr_t>(&marker) < _limit;
+        }
+
+      private:
+        explicit NativeStack(uintptr_t limit)
+            : _limit(limit)
+        {
+        }
+
+        uintptr_t _limit = 0;
+    };
+}  // namespace sail
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sail
+{
+    enum class Register : uint8_t
+    {
+        eRax,
+        eRcx,
+        eRdx,
+        eRbx,
+        eRsp,
+        eRbp,
+        eRsi,
+        eRdi,
+        eR8,
+        eR9,
+        eR10,
+        eR11,
+        eR12,
+        eR13,
+        eR14,
+        eR15,
+    };
+
+    enum class XmmRegister : uint8_t
+    {
+        eXmm0,
+        eXmm1,
+    };
+
+    // Condition codes, as encoded in jcc and setcc.
+    enum class Condition : uint8_t
+    {
+        eBelow = 0x2,
+        eAboveEqual = 0x3,
+        eEqual = 0x4,
+        eNotEqual = 0x5,
+        eBelowEqual = 0x6,
+        eAbove = 0x7,
+    };
+
+    // Scalar double operations, by their SSE2 opcode.
+    enum class DoubleOperation : uint8_t
+    {
+        eAdd = 0x58,
+        eMultiply = 0x59,
+        eSubtract = 0x5c,
+        eDivide = 0x5e,
+    };
+
+    // Encodes the handful of x86-64 instructions the JitCompiler's templates are made of. Memory
+    // operands are always a base register plus a 32-bit displacement. Jumps take 32-bit offsets:
+    // forward ones return the position of their offset, to be patched once the target is known.
+    class Assembler
+    {
+      public:
+        void push(Register reg);
+        void pop(Register reg);
+        void mov(Register destination, Register source);
+        void mov(Register destination, uint64_t immediate);
+        void mov32(Register destination, uint32_t immediate);
+        void load(Register destination, Register base, int32_t displacement);
+        void store(Register base, int32_t displacement, Register source);
+        void add(Register destination, int32_t immediate);
+        void sub(Register destination, int32_t immediate);
+        void bitwiseAnd(Register destination, Register source);
+        void bitwiseOr(Register destination, Register source);
+        void bitwiseXor(Register destination, Register source);
+        void cmp(Register left, Register right);
+        void test(Register left, Register right);
+        // Tests the low byte of the register, where functions return a bool.
+        void testByte(Register reg);
+        // Sets the register to 1 if the condition holds and to 0 otherwise.
+        void set(Condition condition, Register destination);
+
+        void movq(XmmRegister destination, Register source);
+        void movq(Register destination, XmmRegister source);
+        void arithmetic(DoubleOperation operation, XmmRegister destination, XmmRegister source);
+        void ucomisd(XmmRegister left, XmmRegister right);
+
+        auto jump() -> size_t;
+        auto jump(Condition condition) -> size_t;
+        void jumpTo(size_t target);
+        void jumpTo(Condition condition, size_t target);
+        // Points the jump whose offset is at the position to the target.
+        void patch(size_t position, size_t target);
+
+        void call(Register target);
+        void ret();
+
+        auto size() const -> size_t { return _code.size(); }
+        auto code() const -> const std::vector<uint8_t>& { return _code; }
+
+      private:
+        void emit(uint8_t byte);
+        void emit32(uint32_t value);
+        void emit64(uint64_t value);
+        void rex(bool wide, uint8_t reg, uint8_t base);
+        void registers(uint8_t opCode, Register destination, Register source);
+        void memory(uint8_t opCode, Register reg, Register base, int32_t displacement);
+
+        std::vector<uint8_t> _code;
+    };
+}  // namespace sail
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Bytecode/Value.h"
+#include "Objects/FunctionObject.h"
+#include "utils/classes.h"
+
+// Compiled code relies on the NaN-boxed value layout, the System V calling convention and mmap.
+#if defined(SAIL_JIT) && defined(SAIL_NAN_BOXING) && defined(__x86_64__) && defined(__linux__)
+#    define SAIL_JIT_SUPPORTED 1
+#else
+#    define SAIL_JIT_SUPPORTED 0
+#endif
+
+namespace sail
+{
+    class VirtualMachine;
+
+    // Entry point compiled code calls back into the machine through. It executes the instruction
+    // at the given address as the given opcode, the way the interpreter would, and returns the new
+    // stack top, or null once a runtime error has been raised.
+    using SlowPath = Bytecode::Value* (*)(VirtualMachine* machine,
+                                          Bytecode::Value* stackTop,
+                                          const uint8_t* instruction,
+                                          uint32_t opCode);
+
+    // Baseline compiler from bytecode to x86-64 machine code. Every instruction becomes a fixed
+    // template working on the machine's value stack, with the frame's slots and the stack top kept
+    // in registers. Arithmetic, comparisons and branches on numbers run inline; other operand
+    // types and every other instruction (globals, upvalues, calls, closures, classes and property
+    // accesses) go through the slow path.
+    class JitCompiler
+    {
+      public:
+        explicit JitCompiler(SlowPath slowPath);
+        ~JitCompiler();
+
+        SAIL_DELETE_COPY_MOVE(JitCompiler);
+
+        // Sets the function's compiled code and loop entries. Returns false if no executable memory
+        // could be mapped for it.
+        auto compile(Objects::Function& function) -> bool;
+
+      private:
+        SlowPath _slowPath;
+        // Executable mappings holding compiled code, released with the compiler.
+        std::vector<std::pair<void*, size_t>> _regions;
+    };
+}  // namespace sail
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Bytecode/Value.h"
+#include "Memory/HeapRoots.h"
+#include "Objects/Object.h"
+#include "ankerl/unordered_dense.h"
+#include "utils/classes.h"
+
+namespace sail
+{
+    namespace Objects
+    {
+        struct String;
+    }  // namespace Objects
+
+    struct HeapStatistics
+    {
+        // Bytes held by live objects plus everything allocated since the last collection.
+        size_t bytesAllocated = 0;
+        size_t peakBytesAllocated = 0;
+        size_t objectCount = 0;
+
+        // Full collections trace the whole heap; minor collections only trace the nursery.
+        size_t collections = 0;
+        size_t minorCollections = 0;
+        size_t bytesPromoted = 0;
+        size_t objectsFreed = 0;
+        size_t bytesFreed = 0;
+
+        // Every stretch of time the mutator was stopped for collection work: minor collections,
+        // full collections and the individual slices of an incremental cycle.
+        size_t pauses = 0;
+        std::chrono::nanoseconds totalPause {0};
+        std::chrono::nanoseconds maxPause {0};
+
+        auto averagePause() const -> std::chrono::nanoseconds
+        {
+            if (pauses == 0)
+            {
+                return std::chrono::nanoseconds {0};
+            }
+            return totalPause / static_cast<std::chrono::nanoseconds::rep>(pauses);
+        }
+
+        friend auto operator<<(std::ostream& ostr, const HeapStatistics& statistics)
+            -> std::ostream&;
+    };
+
+    // Owns every object used by the virtual machine and reclaims unreachable ones by tracing.
+    //
+    // The heap is generational. New objects are bump-allocated into nursery blocks, and once the
+    // nursery is full a minor collection traces only the young objects reachable from the roots
+    // and from the remembered set. Survivors are promoted in place, because objects are referenced
+    // by raw pointers throughout the machine and cannot move. A block stays pinned until every
+    // object promoted out of it has died. A full mark-and-sweep runs when the old generation passes
+    // a threshold, which is then reset to a multiple of the bytes that survived.
+    //
+    // With a slice budget set, that full collection runs incrementally instead: marking and
+    // sweeping are split into slices that run as the mutator allocates, each one stopping once the
+    // budget is spent. Marking is tri-color. Objects allocated while it runs start out gray, and
+    // the write barrier shades anything stored into an object that is already marked. Roots are not
+    // barriered, so they are scanned again in a final remark before sweeping starts. Minor
+    // collections are held off until marking has finished.
+    //
+    // Strings are interned through a table that holds them weakly.
+    //
+    // Storing a reference into an existing object has to go through writeBarrier(). Collections
+    // only happen inside allocate(), before the new object is created, so any object passed to a
+    // constructor must already be reachable from a root.
+    class Heap
+    {
+      public:
+        static constexpr size_t kBlockSize = 64 * 1024;
+        static constexpr size_t kNurseryBlocks = 4;
+        static constexpr size_t kInitialThreshold = 1024 * 1024;
+        static constexpr size_t kGrowthFactor = 2;
+        // Bytes allocated between two slices of an incremental collection.
+        static constexpr size_t kSliceInterval = 16 * 1024;
+
+        Heap() = default;
+        ~Heap();
+
+        SAIL_DELETE_COPY_MOVE(Heap);
+
+        template<typename T, typename... Args>
+        auto allocate(Args&&... args) -> T*
+        {
+            static_assert(sizeof(T) <= kBlockSize - sizeof(Block));
+
+            void* memory = allocateYoung(sizeof(T));
+            T* object = new (memory) T(std::forward<Args>(args)...);
+            track(object, sizeof(T));
+            return object;
+        }
+
+        // Returns the one string object holding these characters, creating it if needed. The
+        // table does not keep strings alive. Must not be given characters owned by a heap object,
+        // since creating the string can collect.
+        auto intern(std::string_view chars) -> Objects::String*;
+
+        void writeBarrier(Object* owner, Object* target)
+        {
+            if (target == nullptr)
+            {
+                return;
+            }
+            if (owner->old && !owner->remembered && !target->old)
+            {
+                remember(owner);
+            }
+            if (_phase == Phase::eMarking && owner->marked)
+            {
+                markObject(target);
+            }
+        }
+        void writeBarrier(Object* owner, Bytecode::Value value)
+        {
+            if (value.isObject())
+            {
+                writeBarrier(owner, value.asObject());
+            }
+        }
+
+        void addRoots(HeapRoots* roots);
+        void removeRoots(HeapRoots* roots);
+
+        // Zero makes every full collection a single stop-the-world pause.
+        void setSliceBudget(std::chrono::microseconds budget) { _sliceBudget = budget; }
+
+        // Both finish an incremental cycle that is already in progress first.
+        void collect();
+        void collectNursery();
+
+        void markValue(Bytecode::Value value);
+        void markObject(Object* object);
+
+        auto statistics() const -> const HeapStatistics& { return _statistics; }
+
+      private:
+        enum class Phase
+        {
+            eIdle,
+            eMarking,
+            eSweeping,
+        };
+
+        // Header at the start of every nursery block. Blocks are aligned to their size, so the
+        // block an object lives in can be found from its address.
+        struct Block
+        {
+            size_t liveObjects = 0;
+        };
+
+        static auto blockOf(Object* object) -> Block*
+        {
+            return reinterpret_cast<Block*>(reinterpret_cast<uintptr_t>(object)
+                                            & ~(uintptr_t {kBlockSize} - 1));
+        }
+
+        auto allocateYoung(size_t size) -> void*;
+        auto newBlock() -> Block*;
+        void releaseEmptyBlocks();
+
+        void track(Object* object, size_t size);
+        void remember(Object* object);
+        void forgetRemembered();
+        void markRootSets();
+        void traceReferences();
+        void blacken(Object* object);
+        void removeUnmarkedStrings();
+        void promoteNursery();
+        void sweepOldGeneration();
+        void destroy(Object* object);
+
+        void fullCollection();
+        void minorCollection();
+        void startCycle();
+        void step();
+        void finishMarking();
+        void finishCycle();
+        auto sweepSome(size_t count) -> bool;
+
+        template<typename Work>
+        void pause(Work&& work);
+
+        Object* _objects = nullptr;
+        Object* _youngObjects = nullptr;
+        std::vector<Object*> _grayStack;
+        std::vector<Object*> _rememberedSet;
+        std::vector<HeapRoots*> _roots;
+        bool _tracingNursery = false;
+        ankerl::unordered_dense::map<std::string_view, Objects::String*> _strings;
+
+        Phase _phase = Phase::eIdle;
+        std::chrono::microseconds _sliceBudget {0};
+        size_t _bytesSinceSlice = 0;
+        // Old objects still to be swept by the current cycle. Survivors are moved back to _objects.
+        Object* _sweepList = nullptr;
+
+        // The block currently being bump-allocated into, filled blocks that still hold live
+        // objects, and empty blocks kept for reuse.
+        Block* _activeBlock = nullptr;
+        std::vector<Block*> _fullBlocks;
+        std::vector<Block*> _freeBlocks;
+        std::byte* _cursor = nullptr;
+        std::byte* _limit = nullptr;
+
+        size_t _youngBytes = 0;
+        size_t _oldBytes = 0;
+        size_t _nextCollection = kInitialThreshold;
+        HeapStatistics _statistics;
+    };
+}  // namespace sail
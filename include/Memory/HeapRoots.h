@@ -0,0 +1,22 @@
+#pragma once
+
+#include "utils/classes.h"
+
+namespace sail
+{
+    class Heap;
+
+    // Implemented by anything that holds references to heap objects from outside the heap, such as
+    // the virtual machine's stack or a function being compiled. The Heap asks every registered
+    // root set to mark its references at the start of a collection.
+    class HeapRoots
+    {
+      public:
+        HeapRoots() = default;
+        virtual ~HeapRoots() = default;
+
+        SAIL_DEFAULT_COPY_MOVE(HeapRoots);
+
+        virtual void markRoots(Heap& heap) = 0;
+    };
+}  // namespace sail
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "utils/classes.h"
+
+namespace sail
+{
+    namespace VirtualMemory
+    {
+        // Reserves zeroed memory that the operating system only backs with pages as they are
+        // first touched. Throws std::bad_alloc when the address space runs out.
+        auto reserve(size_t bytes) -> void*;
+        void release(void* memory, size_t bytes);
+    }  // namespace VirtualMemory
+
+    // Fixed-size array for a worst case that is rarely reached, such as the deepest allowed call
+    // nesting. Only the part actually used costs memory. Elements start out as zero bytes instead
+    // of being constructed.
+    template<typename T>
+    class ReservedArray
+    {
+        static_assert(std::is_trivially_destructible_v<T>);
+        static_assert(std::is_trivially_copyable_v<T>);
+
+      public:
+        explicit ReservedArray(size_t size)
+            : _data(static_cast<T*>(VirtualMemory::reserve(size * sizeof(T))))
+            , _size(size)
+        {
+        }
+
+        ~ReservedArray() { VirtualMemory::release(_data, _size * sizeof(T)); }
+
+        SAIL_DELETE_COPY_MOVE(ReservedArray);
+
+        auto get() const -> T* { return _data; }
+        auto size() const -> size_t { return _size; }
+        auto operator[](size_t index) const -> T& { return _data[index]; }
+
+      private:
+        T* _data;
+        size_t _size;
+    };
+}  // namespace sail
@@ -4,5 +4,8 @@
 
 namespace sail
 {
+    class VirtualMachine;
+
     void defineNativeFunctions(Environment& environment);
+    void defineNativeFunctions(VirtualMachine& machine);
 }
\ No newline at end of file
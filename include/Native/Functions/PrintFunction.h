@@ -1,8 +1,16 @@
 #pragma once
 
+#include <span>
+
+#include "Bytecode/Value.h"
 #include "Types/CallableType.h"
 #include "Types/Value.h"
 
+namespace sail
+{
+    class VirtualMachine;
+}  // namespace sail
+
 namespace sail::Native::Functions
 {
     class Print : public Types::Callable
@@ -10,7 +18,7 @@ namespace sail::Native::Functions
       public:
         Print() = default;
 
-        auto call(Interpreter& interpreter, std::vector<Value>& arguments)
+        auto call(Interpreter& interpreter, std::span<Value> arguments)
             -> Value override;
         auto arity() const -> size_t override;
 
@@ -19,4 +27,6 @@ namespace sail::Native::Functions
       private:
         const std::string _name = "print";
     };
+
+    auto print(VirtualMachine& machine, std::span<Bytecode::Value> arguments) -> Bytecode::Value;
 }  // namespace sail::Native::Functions
\ No newline at end of file
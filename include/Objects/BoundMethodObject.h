@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Bytecode/Value.h"
+#include "ClosureObject.h"
+#include "Object.h"
+
+namespace sail::Objects
+{
+    struct BoundMethod final : public Object
+    {
+        Bytecode::Value receiver;
+        Closure* method;
+
+        BoundMethod(Bytecode::Value receiver, Closure* method)
+            : Object(ObjectType::eBoundMethod)
+            , receiver(receiver)
+            , method(method)
+        {
+        }
+    };
+}  // namespace sail::Objects
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+#include "ClosureObject.h"
+#include "Object.h"
+#include "StringObject.h"
+#include "ankerl/unordered_dense.h"
+
+namespace sail::Objects
+{
+    struct Class final : public Object
+    {
+        std::string name;
+        Class* superclass = nullptr;
+        ankerl::unordered_dense::map<String*, Closure*, StringHash> methods;
+
+        explicit Class(std::string name)
+            : Object(ObjectType::eClass)
+            , name(std::move(name))
+        {
+        }
+
+        auto findMethod(String* methodName) const -> Closure*;
+    };
+}  // namespace sail::Objects
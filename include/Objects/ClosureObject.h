@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+
+#include "FunctionObject.h"
+#include "Object.h"
+#include "UpvalueObject.h"
+
+namespace sail::Objects
+{
+    struct Closure final : public Object
+    {
+        Function* function;
+        std::vector<Upvalue*> upvalues;
+
+        explicit Closure(Function* function)
+            : Object(ObjectType::eClosure)
+            , function(function)
+            , upvalues(function->upvalueCount, nullptr)
+        {
+        }
+    };
+}  // namespace sail::Objects
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Bytecode/Chunk.h"
+#include "Object.h"
+
+namespace sail
+{
+    class VirtualMachine;
+}  // namespace sail
+
+namespace sail::Objects
+{
+    // Machine code the JitCompiler produced for a function. It runs a frame the machine has already
+    // pushed, given the frame's slots and the stack top, and returns the stack top with the result
+    // pushed in place of the callee, or null once a runtime error has been raised.
+    using CompiledCode = Bytecode::Value* (*)(VirtualMachine* machine,
+                                              Bytecode::Value* slots,
+                                              Bytecode::Value* stackTop);
+
+    struct Function final : public Object
+    {
+        Bytecode::Chunk chunk;
+        size_t arity = 0;
+        size_t upvalueCount = 0;
+        std::string name;
+
+        // Calls and loop iterations so far, counted until the function is handed to the
+        // JitCompiler.
+        size_t callCount = 0;
+        size_t backEdgeCount = 0;
+        CompiledCode compiled = nullptr;
+        // Entries into the compiled code at the start of each loop, by bytecode offset, taking the
+        // same arguments. An interpreted frame stuck in a long loop switches over through them.
+        std::vector<std::pair<size_t, CompiledCode>> loopEntries;
+        // Set when the JitCompiler could not compile the function, so it is not tried again.
+        bool interpretOnly = false;
+
+        explicit Function(std::string name)
+            : Object(ObjectType::eFunction)
+            , name(std::move(name))
+        {
+        }
+    };
+}  // namespace sail::Objects
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+#include "Bytecode/Value.h"
+#include "ClassObject.h"
+#include "Object.h"
+#include "StringObject.h"
+#include "ankerl/unordered_dense.h"
+
+namespace sail::Objects
+{
+    struct Instance final : public Object
+    {
+        Class* klass;
+        ankerl::unordered_dense::map<String*, Bytecode::Value, StringHash> fields;
+
+        explicit Instance(Class* klass)
+            : Object(ObjectType::eInstance)
+            , klass(klass)
+        {
+        }
+    };
+}  // namespace sail::Objects
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <span>
+#include <string>
+
+#include "Bytecode/Value.h"
+#include "Object.h"
+
+namespace sail
+{
+    class VirtualMachine;
+}  // namespace sail
+
+namespace sail::Objects
+{
+    using NativeFunction = auto (*)(VirtualMachine& machine, std::span<Bytecode::Value> arguments)
+        -> Bytecode::Value;
+
+    struct Native final : public Object
+    {
+        NativeFunction function;
+        size_t arity;  // std::numeric_limits<size_t>::max() accepts any number of arguments
+        std::string name;
+
+        Native(NativeFunction function, size_t arity, std::string name)
+            : Object(ObjectType::eNative)
+            , function(function)
+            , arity(arity)
+            , name(std::move(name))
+        {
+        }
+    };
+}  // namespace sail::Objects
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "utils/classes.h"
+
+namespace sail
+{
+    enum class ObjectType : uint8_t
+    {
+        eBoundMethod,
+        eClass,
+        eClosure,
+        eFunction,
+        eInstance,
+        eNative,
+        eString,
+        eUpvalue,
+    };
+
+    // Base of every heap object used by the virtual machine. Objects are allocated through
+    // VirtualMachine::allocate, which places them in the machine's Heap. Objects never move, but
+    // references stored into an existing object must go through Heap::writeBarrier.
+    struct Object
+    {
+        explicit Object(ObjectType type)
+            : type(type)
+        {
+        }
+        virtual ~Object() = default;
+
+        SAIL_DELETE_COPY_MOVE(Object);
+
+        ObjectType type;
+        bool marked = false;
+        // Set once the object has survived a collection and been promoted out of the nursery.
+        bool old = false;
+        // Set while the object is in the heap's remembered set.
+        bool remembered = false;
+        size_t size = 0;
+        Object* next = nullptr;
+    };
+}  // namespace sail
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "BoundMethodObject.h"
+#include "ClassObject.h"
+#include "ClosureObject.h"
+#include "FunctionObject.h"
+#include "InstanceObject.h"
+#include "NativeObject.h"
+#include "Object.h"
+#include "StringObject.h"
+#include "UpvalueObject.h"
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Object.h"
+#include "ankerl/unordered_dense.h"
+
+namespace sail::Objects
+{
+    // Strings are immutable and interned by the Heap, so two strings with the same contents are
+    // always the same object and can be compared and hashed by pointer.
+    struct String final : public Object
+    {
+        std::string value;
+        uint64_t hash;
+
+        explicit String(std::string value)
+            : Object(ObjectType::eString)
+            , value(std::move(value))
+            , hash(ankerl::unordered_dense::hash<std::string_view> {}(this->value))
+        {
+        }
+    };
+
+    // Hashes interned strings by their precomputed hash, for maps keyed by String*.
+    struct StringHash
+    {
+        using is_avalanching = void;
+
+        auto operator()(const String* string) const noexcept -> uint64_t { return string->hash; }
+    };
+}  // namespace sail::Objects
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Bytecode/Value.h"
+#include "Object.h"
+
+namespace sail::Objects
+{
+    // A variable captured by a closure. While the variable is still on the stack the upvalue is
+    // open and points at its slot; once the slot goes out of scope the value is moved into closed.
+    struct Upvalue final : public Object
+    {
+        Bytecode::Value* location;
+        Bytecode::Value closed;
+        Upvalue* nextOpen = nullptr;
+
+        explicit Upvalue(Bytecode::Value* location)
+            : Object(ObjectType::eUpvalue)
+            , location(location)
+        {
+        }
+    };
+}  // namespace sail::Objects
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Expressions/Expression.h"
+#include "Statements/Statements.h"
+
+namespace sail
+{
+    // Rewrites the resolved syntax tree before it is run or compiled: folds subtrees whose
+    // operands are all literals, removes groupings and simplifies arithmetic identities. Nodes are
+    // only replaced when the result is the value they would have produced at runtime, so
+    // expressions that would raise an error are left for the engines to report.
+    //
+    // Statements that can never run or have no effect are removed: branches a constant condition
+    // rules out, loops that never start, statements after a return and unused locals whose
+    // initializer has no side effects. Visiting a statement sets it to null to remove it.
+    class Optimizer
+        : public ExpressionVisitor
+        , public StatementVisitor
+    {
+      public:
+        Optimizer() = default;
+
+        void optimize(std::vector<std::shared_ptr<Statement>>& statements);
+        void optimize(std::shared_ptr<Statement>& statement);
+        void optimize(std::shared_ptr<Expression>& expression);
+
+      private:
+        void visitBlockStatement(Statements::Block& blockStatement,
+                                 std::shared_ptr<Statement>& shared) override;
+        void visitClassStatement(Statements::Class& classStatement,
+                                 std::shared_ptr<Statement>& shared) override;
+        void visitExpressionStatement(Statements::Expression& expressionStatement,
+                                      std::shared_ptr<Statement>& shared) override;
+        void visitFunctionStatement(Statements::Function& functionStatement,
+                                    std::shared_ptr<Statement>& shared) override;
+        void visitIfStatement(Statements::If& ifStatement,
+                              std::shared_ptr<Statement>& shared) override;
+        void visitReturnStatement(Statements::Return& returnStatement,
+                                  std::shared_ptr<Statement>& shared) override;
+        void visitVariableStatement(Statements::Variable& variableStatement,
+                                    std::shared_ptr<Statement>& shared) override;
+        void visitWhileStatement(Statements::While& whileStatement,
+                                 std::shared_ptr<Statement>& shared) override;
+
+        void visitAssignmentExpression(Expressions::Assignment& assignmentExpression,
+                                       std::shared_ptr<Expression>& shared) override;
+        void visitBinaryExpression(Expressions::Binary& binaryExpression,
+                                   std::shared_ptr<Expression>& shared) override;
+        void visitCallExpression(Expressions::Call& callExpression,
+                                 std::shared_ptr<Expression>& shared) override;
+        void visitGetExpression(Expressions::Get& getExpression,
+                                std::shared_ptr<Expression>& shared) override;
+        void visitGroupingExpression(Expressions::Grouping& groupingExpression,
+                                     std::shared_ptr<Expression>& shared) override;
+        void visitLiteralExpression(Expressions::Literal& literalExpression,
+                                    std::shared_ptr<Expression>& shared) override;
+        void visitLogicalExpression(Expressions::Logical& logicalExpression,
+                                    std::shared_ptr<Expression>& shared) override;
+        void visitSetExpression(Expressions::Set& setExpression,
+                                std::shared_ptr<Expression>& shared) override;
+        void visitSuperExpression(Expressions::Super& superExpression,
+                                  std::shared_ptr<Expression>& shared) override;
+        void visitThisExpression(Expressions::This& thisExpression,
+                                 std::shared_ptr<Expression>& shared) override;
+        void visitUnaryExpression(Expressions::Unary& unaryExpression,
+                                  std::shared_ptr<Expression>& shared) override;
+        void visitVariableExpression(Expressions::Variable& variableExpression,
+                                     std::shared_ptr<Expression>& shared) override;
+
+        void optimizeFunction(Statements::Function& functionStatement);
+    };
+}  // namespace sail
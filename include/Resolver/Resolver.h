@@ -5,14 +5,14 @@
 #include <string>
 #include <vector>
 
+#include "Expressions/Binding.h"
 #include "Expressions/Expression.h"
+#include "Resolver/Selectors.h"
 #include "Statements/Statements.h"
 #include "ankerl/unordered_dense.h"
 
 namespace sail
 {
-    class Interpreter;
-
     enum class ClassType
     {
         eNone = 1U << 0U,
@@ -33,7 +33,8 @@ namespace sail
         , public StatementVisitor
     {
       public:
-        explicit Resolver(Interpreter& interpreter);
+        // Method declarations are numbered in the given selectors.
+        explicit Resolver(Selectors& selectors);
 
         void resolve(std::vector<std::shared_ptr<Statement>>& statements);
         void resolve(std::shared_ptr<Statement>& statement);
@@ -81,15 +82,42 @@ namespace sail
                                   std::shared_ptr<Expression>& shared) override;
         void visitVariableExpression(Expressions::Variable& variableExpression,
                                      std::shared_ptr<Expression>& shared) override;
+        struct Variable
+        {
+            bool defined;
+            size_t slot;
+            // Whether a closure refers to the variable from a nested function.
+            bool captured = false;
+            // Set for variables declared by a let statement, which is told when they are used.
+            Statements::Variable* declaration = nullptr;
+        };
+
+        // Slots are allocated per function: every scope inside a function takes the slots
+        // following those of the scopes enclosing it, and gives them back when it ends. The
+        // top-level code is the first entry, with no declaration.
+        struct FunctionScope
+        {
+            size_t firstScope = 0;
+            size_t nextSlot = 0;
+            size_t maxSlots = 0;
+            Statements::Function* declaration = nullptr;
+        };
+
         void beginScope();
-        void endScope();
-        void declare(const Token& name);
+        // Returns whether a closure captured any of the scope's variables.
+        auto endScope() -> bool;
+        auto declare(const Token& name) -> Expressions::Binding;
         void define(const Token& name);
+        auto addVariable(const std::string& name, bool defined) -> size_t;
         void resolveFunction(Statements::Function& functionStatement, FunctionType type);
-        void resolveLocal(std::shared_ptr<Expression>& expression, const Token& name);
+        // Marks the call a function ends with, found through the last statement of its body.
+        void markTailCall(Statement& statement);
+        void resolveLocal(Expressions::Binding& binding, const std::string& name);
+        auto addCapture(size_t function, size_t owner, size_t slot) -> size_t;
 
-        Interpreter& _interpreter;
-        std::vector<ankerl::unordered_dense::map<std::string, bool>> _scopes;
+        Selectors& _selectors;
+        std::vector<ankerl::unordered_dense::map<std::string, Variable>> _scopes;
+        std::vector<FunctionScope> _functions {FunctionScope {}};
         ClassType _currentClass = ClassType::eNone;
         FunctionType _currentFunction = FunctionType::eNone;
     };
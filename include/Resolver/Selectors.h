@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "ankerl/unordered_dense.h"
+#include "utils/classes.h"
+
+namespace sail
+{
+    using Selector = uint32_t;
+
+    // Numbers method names so that classes can dispatch through flat method tables. Each Instance
+    // keeps its own numbering, shared by the classes and call sites it resolves, such as those on
+    // different prompt lines. Only names declared as methods are numbered, so a class's table
+    // grows with the number of method names rather than with every property name.
+    class Selectors
+    {
+      public:
+        static constexpr Selector kInitializer = 0;
+        // Left on sites naming a method no class has declared yet. Finds no method.
+        static constexpr Selector kNone = std::numeric_limits<Selector>::max();
+
+        Selectors();
+
+        SAIL_DELETE_COPY_MOVE(Selectors);
+
+        // Numbers the name of a method a class declares.
+        auto declare(const std::string& name) -> Selector;
+        // Returns the name's number, or kNone if no class has declared a method with it.
+        auto find(const std::string& name) const -> Selector;
+
+      private:
+        ankerl::unordered_dense::map<std::string, Selector> _selectors;
+    };
+}  // namespace sail
@@ -11,6 +11,13 @@ namespace sail::Statements
     struct Block final : public Statement
     {
         std::vector<std::shared_ptr<Statement>> statements;
+        // Assigned by the Resolver. The block's locals, including those of nested blocks, use the
+        // frame slots starting at firstSlot.
+        size_t firstSlot = 0;
+        size_t slotCount = 0;
+        // Whether a closure captures one of the block's locals, which then has to be closed over
+        // when the block ends.
+        bool closesUpvalues = false;
 
         void accept(StatementVisitor& visitor, std::shared_ptr<Statement>& shared) override
         {
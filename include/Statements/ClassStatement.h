@@ -12,6 +12,7 @@ namespace sail::Statements
         Token name;
         std::shared_ptr<Expressions::Variable> superclass;
         std::vector<std::shared_ptr<Statements::Function>> methods;
+        Expressions::Binding binding;  // Assigned by the Resolver.
 
         void accept(StatementVisitor& visitor, std::shared_ptr<Statement>& shared) override
         {
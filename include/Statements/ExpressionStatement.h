@@ -10,6 +10,10 @@ namespace sail::Statements
     struct Expression final : public Statement
     {
         std::shared_ptr<sail::Expression> expression;
+        // Set by the Resolver when the expression is a call that is the last thing its function
+        // does. The function then returns null rather than the call's result. Points into
+        // expression.
+        Expressions::Call* tailCall = nullptr;
 
         void accept(StatementVisitor& visitor, std::shared_ptr<Statement>& shared) override
         {
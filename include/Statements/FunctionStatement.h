@@ -2,11 +2,23 @@
 
 #include <memory>
 
+#include "Expressions/Binding.h"
+#include "Resolver/Selectors.h"
 #include "Statement.h"
 #include "Token/Token.h"
 
 namespace sail::Statements
 {
+    // A variable a closure captures when it is created: a slot in the frame creating it, or one of
+    // the upvalues of the closure creating it.
+    struct Capture
+    {
+        bool isLocal;
+        size_t index;
+
+        auto operator==(const Capture&) const -> bool = default;
+    };
+
     struct Function final : public Statement
     {
         Token name;
@@ -14,6 +26,15 @@ namespace sail::Statements
         std::vector<std::shared_ptr<Statement>> body;
         bool possibleInitializer;
 
+        // Assigned by the Resolver. Parameters occupy the first slots of the function's frame,
+        // followed by 'this' and 'super' for methods, then the locals declared in the body and
+        // its blocks. Only variables that closures capture are copied out of the frame.
+        Expressions::Binding binding;
+        size_t slotCount = 0;
+        std::vector<Capture> captures;
+        // Assigned by the Resolver for methods.
+        Selector selector = Selectors::kNone;
+
         void accept(StatementVisitor& visitor, std::shared_ptr<Statement>& shared) override
         {
             visitor.visitFunctionStatement(*this, shared);
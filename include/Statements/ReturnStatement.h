@@ -13,6 +13,9 @@ namespace sail::Statements
     {
         std::shared_ptr<sail::Expression> value;
         Token keyword;
+        // Set by the Resolver when the returned value is a call the function does not have to
+        // outlive, so that it can run in the function's frame. Points into value.
+        Expressions::Call* tailCall = nullptr;
 
         void accept(StatementVisitor& visitor, std::shared_ptr<Statement>& shared) override
         {
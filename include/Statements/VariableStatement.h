@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Expressions/Binding.h"
 #include "Expressions/Expression.h"
 #include "Statement.h"
 
@@ -9,6 +10,9 @@ namespace sail::Statements
     {
         Token name;
         std::shared_ptr<sail::Expression> initializer;
+        Expressions::Binding binding;  // Assigned by the Resolver.
+        // Assigned by the Resolver for locals: whether any expression reads or assigns them.
+        bool referenced = false;
 
         void accept(StatementVisitor& visitor, std::shared_ptr<Statement>& shared) override
         {
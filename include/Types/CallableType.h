@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "Statements/FunctionStatement.h"
@@ -21,8 +22,10 @@ namespace sail::Types
         Callable() = default;
         virtual ~Callable() = default;
 
-        virtual auto call(Interpreter& interpreter,
-                          std::vector<Value>& arguments) -> Value = 0;
+        // The arguments are the top of the interpreter's value stack and belong to this call, so
+        // callees may move from them. They are only valid until the callee evaluates anything;
+        // interpreted functions take them over as the first slots of their frame.
+        virtual auto call(Interpreter& interpreter, std::span<Value> arguments) -> Value = 0;
         virtual auto arity() const -> size_t = 0;
 
         virtual auto name() const -> std::string const& = 0;
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "CallableType.h"
-#include "ankerl/unordered_dense.h"
+#include "Resolver/Selectors.h"
+#include "ShapeType.h"
 
 namespace sail::Types
 {
@@ -15,22 +18,38 @@ namespace sail::Types
         , public std::enable_shared_from_this<Class>
     {
       public:
-        explicit Class(
-            std::string name,
-            std::shared_ptr<Types::Class> superclass,
-            ankerl::unordered_dense::map<std::string, std::shared_ptr<Function>> methods);
+        Class(std::string name,
+              std::shared_ptr<Types::Class> superclass,
+              const std::vector<std::shared_ptr<Function>>& methods);
 
-        auto call(Interpreter& interpreter, std::vector<Value>& arguments) -> Value override;
+        auto call(Interpreter& interpreter, std::span<Value> arguments) -> Value override;
         auto arity() const -> size_t override;
 
         auto name() const -> std::string const& override;
 
-        auto findMemberFunction(const std::string& name) const -> std::shared_ptr<Function>;
+        // Looks the method up in a table that already includes inherited methods, so the cost
+        // does not depend on the depth of the hierarchy.
+        auto findMethod(Selector selector) const -> const std::shared_ptr<Function>&;
         auto superclass() const -> std::shared_ptr<Types::Class> const& { return _superclass; }
 
+        // Every instance starts out with the empty shape, so instances built by the same
+        // initializer follow the same transitions and share a layout.
+        auto rootShape() -> Shape* { return &_rootShape; }
+        // Largest field count seen on an instance, used to size the storage of new instances.
+        auto expectedFieldCount() const -> size_t { return _expectedFieldCount; }
+        void noteFieldCount(size_t count)
+        {
+            _expectedFieldCount = std::max(_expectedFieldCount, count);
+        }
+
       private:
         std::string _name;
         std::shared_ptr<Types::Class> _superclass;
-        ankerl::unordered_dense::map<std::string, std::shared_ptr<Function>> _methods;
+        // Indexed by selector. Starts as a copy of the superclass's table, with the class's own
+        // methods written over it.
+        std::vector<std::shared_ptr<Function>> _methods;
+        std::shared_ptr<Function> _initializer;
+        Shape _rootShape;
+        size_t _expectedFieldCount = 0;
     };
 }  // namespace sail::Types
\ No newline at end of file
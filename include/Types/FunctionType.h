@@ -1,11 +1,13 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "CallableType.h"
-#include "Environment/Environment.h"
+#include "Interpreter/CompiledTree.h"
 #include "Interpreter/Interpreter.h"
+#include "Types/UpvalueType.h"
 #include "Types/Value.h"
 
 namespace sail::Types
@@ -14,24 +16,35 @@ namespace sail::Types
     {
       public:
         Function(std::shared_ptr<Statements::Function> body,
-                 std::shared_ptr<Environment> closure,
-                 bool isInitializer = false);
+                 std::vector<std::shared_ptr<Upvalue>> upvalues,
+                 bool isInitializer = false,
+                 std::shared_ptr<Class> superclass = nullptr,
+                 std::shared_ptr<const CompiledStatement> compiledBody = nullptr);
 
-        auto call(Interpreter& interpreter, std::vector<Value>& arguments) -> Value override;
+        auto call(Interpreter& interpreter, std::span<Value> arguments) -> Value override;
         auto call(Interpreter& interpreter,
-                  std::vector<Value>& arguments,
+                  std::span<Value> arguments,
                   std::shared_ptr<Instance> instance) -> Value;
         auto arity() const -> size_t override;
 
         auto name() const -> std::string const& override;
+        auto selector() const -> Selector { return _body->selector; }
 
-      private:
-        auto process(Interpreter& interpreter,
-                     std::vector<Value>& arguments,
-                     std::shared_ptr<Environment>& environment) -> Value;
+        auto declaration() const -> Statements::Function& { return *_body; }
+        auto upvalues() const -> const std::vector<std::shared_ptr<Upvalue>>& { return _upvalues; }
+        auto superclass() const -> const std::shared_ptr<Class>& { return _superclass; }
+        auto isInitializer() const -> bool { return _isInitializer; }
+        // Set when the ClosureCompiler built the function, replacing the body's statements.
+        auto compiledBody() const -> const CompiledStatement* { return _compiledBody.get(); }
 
+      private:
         std::shared_ptr<Statements::Function> _body;
-        std::shared_ptr<Environment> _closure;
+        // The variables of enclosing functions this closure uses, in the order of the
+        // declaration's captures.
+        std::vector<std::shared_ptr<Upvalue>> _upvalues;
+        // Superclass of the class declaring this method, bound to 'super' when it is invoked.
+        std::shared_ptr<Class> _superclass;
+        std::shared_ptr<const CompiledStatement> _compiledBody;
 
         bool _isInitializer;
     };
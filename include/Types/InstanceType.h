@@ -4,22 +4,32 @@
 #include <vector>
 
 #include "ClassType.h"
-#include "ankerl/unordered_dense.h"
+#include "Expressions/InlineCache.h"
+#include "ShapeType.h"
 
 namespace sail::Types
 {
+    // Fields are stored in a flat array, in the slots given by the instance's shape.
     class Instance : public std::enable_shared_from_this<Instance>
     {
       public:
         explicit Instance(std::shared_ptr<Class> klass);
 
-        auto get(const Token& name) -> Value;
-        auto set(const Token& name, Value value) -> void;
+        // Property accesses are split into a lookup, whose result depends only on the shape and
+        // can be cached per site, and an access that applies it.
+        auto resolveGet(const Token& name, Selector selector) const
+            -> Expressions::PropertyCacheEntry;
+        auto resolveSet(const Token& name) const -> Expressions::PropertyCacheEntry;
+        auto get(const Expressions::PropertyCacheEntry& entry) -> Value;
+        void set(const Expressions::PropertyCacheEntry& entry, Value value);
+
+        auto shape() const -> const Shape* { return _shape; }
 
         auto toString() const -> std::string;
 
       private:
         std::shared_ptr<Class> _klass;
-        ankerl::unordered_dense::map<std::string, Value> _fields;
+        Shape* _shape;
+        std::vector<Value> _fields;
     };
 }  // namespace sail::Types
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "CallableType.h"
@@ -15,11 +16,13 @@ namespace sail::Types
         Method(std::shared_ptr<Instance> instance,
                std::shared_ptr<Function> method);
 
-        auto call(Interpreter& interpreter, std::vector<Value>& arguments)
+        auto call(Interpreter& interpreter, std::span<Value> arguments)
             -> Value override;
         auto arity() const -> size_t override;
 
         auto name() const -> std::string const& override;
+        auto instance() const -> const std::shared_ptr<Instance>& { return _instance; }
+        auto function() const -> const std::shared_ptr<Function>& { return _function; }
 
       private:
         std::shared_ptr<Instance> _instance;
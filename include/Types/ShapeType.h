@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "ankerl/unordered_dense.h"
+#include "utils/classes.h"
+
+namespace sail::Types
+{
+    // Hidden class describing where each field of an instance is stored. Adding a field moves an
+    // instance along a transition to a child shape, so instances that get the same fields in the
+    // same order end up sharing one shape. Each class owns the tree of shapes rooted at its empty
+    // shape, and instances only point into it.
+    class Shape
+    {
+      public:
+        Shape() = default;
+
+        SAIL_DELETE_COPY_MOVE(Shape);
+
+        auto slotOf(const std::string& name) const -> std::optional<size_t>;
+        auto fieldCount() const -> size_t { return _slots.size(); }
+
+        // Returns the shape with the extra field stored in the next slot, creating it on first use.
+        auto withField(const std::string& name) -> Shape*;
+
+      private:
+        Shape(const Shape& parent, const std::string& name);
+
+        ankerl::unordered_dense::map<std::string, size_t> _slots;
+        ankerl::unordered_dense::map<std::string, std::unique_ptr<Shape>> _transitions;
+    };
+}  // namespace sail::Types
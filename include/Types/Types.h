@@ -6,4 +6,6 @@
 #include "InstanceType.h"
 #include "MethodType.h"
 #include "NullType.h"
+#include "ShapeType.h"
+#include "UpvalueType.h"
 #include "Value.h"
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Types/Value.h"
+
+namespace sail::Types
+{
+    // A variable captured by a closure. While the frame declaring it is running the upvalue is
+    // open and refers to the variable's stack slot; once the variable goes out of scope its value
+    // is moved into the upvalue, which every closure capturing it shares.
+    struct Upvalue
+    {
+        size_t slot;
+        Value closed {};
+        bool open = true;
+    };
+}  // namespace sail::Types
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include "Bytecode/OpCode.h"
+
+namespace sail
+{
+    // How many instructions of each opcode the virtual machine dispatched, and how often each
+    // opcode directly followed another. Only recorded by builds with SAIL_DISPATCH_STATS, since
+    // counting slows down every dispatch.
+    struct DispatchStatistics
+    {
+        static constexpr size_t kOpCodes = Bytecode::kOpCodeCount;
+
+        std::array<uint64_t, kOpCodes> instructions {};
+        std::array<std::array<uint64_t, kOpCodes>, kOpCodes> pairs {};
+
+        void record(uint8_t opCode)
+        {
+            instructions[opCode]++;
+            if (_previous < kOpCodes)
+            {
+                pairs[_previous][opCode]++;
+            }
+            _previous = opCode;
+        }
+
+        auto total() const -> uint64_t;
+
+        friend auto operator<<(std::ostream& ostr, const DispatchStatistics& statistics)
+            -> std::ostream&;
+
+      private:
+        size_t _previous = kOpCodes;
+    };
+}  // namespace sail
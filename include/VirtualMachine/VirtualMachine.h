@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Bytecode/OpCode.h"
+#include "Bytecode/Value.h"
+#include "Jit/JitCompiler.h"
+#include "Memory/Heap.h"
+#include "Memory/HeapRoots.h"
+#include "Memory/ReservedArray.h"
+#include "Objects/Objects.h"
+#include "VirtualMachine/DispatchStatistics.h"
+#include "ankerl/unordered_dense.h"
+#include "utils/classes.h"
+
+namespace sail
+{
+    // Executes functions produced by the Compiler. Locals live on a single value stack and calls push
+    // frames instead of recursing on the native stack.
+    class VirtualMachine final : public HeapRoots
+    {
+      public:
+        static constexpr size_t kDefaultMaxCallDepth = 1024;
+        // Value stack reserved for each frame: its locals and temporaries.
+        static constexpr size_t kFrameSlots = 256;
+        // Compiled code calls through the native stack, so only this many nested frames run
+        // compiled. Deeper frames are left to the dispatch loop, which does not recurse.
+        static constexpr size_t kCompiledDepthMax = 256;
+
+        // Address space for the frames and value stack of maxCallDepth nested calls is reserved up
+        // front, but memory is only taken as calls reach it. A call beyond that depth raises a
+        // RuntimeError.
+        explicit VirtualMachine(size_t maxCallDepth = kDefaultMaxCallDepth);
+        ~VirtualMachine() override;
+
+        SAIL_DELETE_COPY_MOVE(VirtualMachine);
+
+        void interpret(Objects::Function* script);
+
+        // Compiles functions to machine code once they have been called callThreshold times, or
+        // once their loops have jumped back loopThreshold times. A frame running such a loop moves
+        // to the compiled code at the loop's start. Does nothing where the JitCompiler is not
+        // supported.
+        void enableJit(size_t callThreshold, size_t loopThreshold);
+
+        template<typename T, typename... Args>
+        auto allocate(Args&&... args) -> T*
+        {
+            return _heap.allocate<T>(std::forward<Args>(args)...);
+        }
+
+        auto intern(std::string_view chars) -> Objects::String* { return _heap.intern(chars); }
+
+        auto heap() -> Heap& { return _heap; }
+        auto dispatchStatistics() const -> const DispatchStatistics& { return _dispatchStatistics; }
+        void markRoots(Heap& heap) override;
+
+        // Globals are bound to slots when code referencing them is compiled, so the same name maps
+        // to the same slot across every chunk run on this machine.
+        auto globalSlot(const std::string& name) -> uint16_t;
+        void defineNative(const std::string& name, Objects::NativeFunction function, size_t arity);
+
+      private:
+        struct CallFrame
+        {
+            Objects::Closure* closure;
+            uint8_t* ip;
+            Bytecode::Value* slots;
+            // Set once a tail call from an expression statement has taken the frame over, as the
+            // frame's original function returns null.
+            bool discardsResult;
+        };
+
+        struct Global
+        {
+            std::string name;
+            Bytecode::Value value {};
+            bool defined = false;
+        };
+
+        // Runs until the frame count drops back to exitDepth, leaving the returned value pushed
+        // unless the last frame returned.
+        void run(size_t exitDepth = 0);
+
+        void push(Bytecode::Value value) { *_stackTop++ = value; }
+        auto pop() -> Bytecode::Value { return *--_stackTop; }
+        auto peek(size_t distance) const -> Bytecode::Value { return _stackTop[-1 - distance]; }
+
+        void callValue(Bytecode::Value callee, uint8_t argumentCount);
+        void call(Objects::Closure* closure, uint8_t argumentCount);
+        // Runs a closure in the current frame in place of its function, or calls any other callee
+        // like callValue. Returns whether the frame was taken over.
+        auto tailCall(uint8_t argumentCount, bool discardResult) -> bool;
+        auto captureUpvalue(Bytecode::Value* local) -> Objects::Upvalue*;
+        void closeUpvalues(const Bytecode::Value* last);
+        void concatenate();
+        void getProperty(Objects::String* name);
+        void setProperty(Objects::String* name);
+        void getSuper(Objects::String* name);
+        // Pushes a closure over the function, capturing the upvalues the operands describe.
+        void makeClosure(Objects::Function* function, const uint8_t* upvalues, CallFrame& frame);
+        void inherit();
+        void defineMethod(Objects::String* name);
+
+#if SAIL_JIT_SUPPORTED
+        void tierUp(Objects::Function& function);
+        // Both leave the frame to the dispatch loop if a tail call exits the compiled code without
+        // running another compiled function in it, and pop it otherwise.
+        void runCompiled(CallFrame& frame);
+        // Runs the rest of the frame as compiled code from the loop starting at loopStart, if the
+        // function has been compiled. Returns whether it did.
+        auto runCompiledLoop(CallFrame& frame, const uint8_t* loopStart) -> bool;
+        // Takes over once compiled code has returned the stack top. Returns whether the frame goes
+        // on with another compiled function from its start.
+        auto leaveCompiled(CallFrame& frame, Bytecode::Value* top) -> bool;
+        static auto compiledSlowPath(VirtualMachine* machine,
+                                     Bytecode::Value* stackTop,
+                                     const uint8_t* instruction,
+                                     uint32_t opCode) -> Bytecode::Value*;
+        void executeSlowPath(Bytecode::OpCode opCode, const uint8_t* operands);
+        void arithmetic(Bytecode::OpCode opCode);
+#endif
+
+        [[noreturn]] void runtimeError(const std::string& message);
+        void resetStack();
+
+        // Declared first so it outlives every member that references its objects.
+        Heap _heap;
+
+        ReservedArray<Bytecode::Value> _stack;
+        Bytecode::Value* _stackTop;
+        ReservedArray<CallFrame> _frames;
+        size_t _frameCount = 0;
+        Objects::Upvalue* _openUpvalues = nullptr;
+        Objects::String* _initString = nullptr;
+        DispatchStatistics _dispatchStatistics;
+
+        std::vector<Global> _globals;
+        ankerl::unordered_dense::map<std::string, uint16_t> _globalSlots;
+
+#if SAIL_JIT_SUPPORTED
+        std::unique_ptr<JitCompiler> _jit;
+        size_t _jitThreshold = 0;
+        size_t _jitLoopThreshold = 0;
+        // Compiled frames currently running on the native stack.
+        size_t _compiledDepth = 0;
+        // Set by a tail call made from compiled code, which then exits with its frame still live.
+        bool _compiledTailCall = false;
+        // Raised inside compiled code, which exceptions cannot unwind through.
+        std::exception_ptr _jitError;
+#endif
+    };
+}  // namespace sail
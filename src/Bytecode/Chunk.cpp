@@ -0,0 +1,63 @@
+#include "Bytecode/Chunk.h"
+
+#include "Objects/FunctionObject.h"
+
+namespace sail::Bytecode
+{
+    void Chunk::write(uint8_t byte, size_t line)
+    {
+        code.push_back(byte);
+        lines.push_back(line);
+    }
+
+    void Chunk::write(OpCode opCode, size_t line)
+    {
+        write(static_cast<uint8_t>(opCode), line);
+    }
+
+    auto Chunk::addConstant(Value value) -> size_t
+    {
+        constants.push_back(value);
+        return constants.size() - 1;
+    }
+
+    auto Chunk::instructionLength(size_t offset) const -> size_t
+    {
+        switch (static_cast<OpCode>(code[offset]))
+        {
+            case OpCode::eGetLocal:
+            case OpCode::eSetLocal:
+            case OpCode::eGetUpvalue:
+            case OpCode::eSetUpvalue:
+            case OpCode::eCall:
+            case OpCode::eSetLocalPop:
+                return 2;
+            case OpCode::eConstant:
+            case OpCode::eGetGlobal:
+            case OpCode::eDefineGlobal:
+            case OpCode::eSetGlobal:
+            case OpCode::eGetProperty:
+            case OpCode::eSetProperty:
+            case OpCode::eGetSuper:
+            case OpCode::eJump:
+            case OpCode::eJumpIfFalse:
+            case OpCode::eLoop:
+            case OpCode::eTailCall:
+            case OpCode::eClass:
+            case OpCode::eMethod:
+            case OpCode::eLessJumpIfFalse:
+            case OpCode::eGreaterJumpIfFalse:
+                return 3;
+            case OpCode::eGetLocalConstant:
+            case OpCode::eIncrementLocal:
+                return 4;
+            case OpCode::eClosure:
+            {
+                auto index = static_cast<uint16_t>((code[offset + 1] << 8U) | code[offset + 2]);
+                return 3 + 2 * constants[index].as<Objects::Function>()->upvalueCount;
+            }
+            default:
+                return 1;
+        }
+    }
+}  // namespace sail::Bytecode
@@ -0,0 +1,118 @@
+#include "Bytecode/Value.h"
+
+#include "Objects/Objects.h"
+
+namespace sail::Bytecode
+{
+    auto Value::isTruthy() const -> bool
+    {
+        switch (type())
+        {
+            case ValueType::eNull:
+                return false;
+            case ValueType::eBool:
+                return asBool();
+            case ValueType::eNumber:
+                return asNumber() != 0;
+            case ValueType::eObject:
+                if (isObjectType(ObjectType::eString))
+                {
+                    return !as<Objects::String>()->value.empty();
+                }
+                return true;
+        }
+
+        return false;
+    }
+
+    auto Value::toNumber() const -> std::optional<double>
+    {
+        if (isNumber())
+        {
+            return asNumber();
+        }
+        if (isBool())
+        {
+            return asBool() ? 1.0 : 0.0;
+        }
+
+        return std::nullopt;
+    }
+
+    auto Value::operator==(const Value& other) const -> bool
+    {
+        if (type() != other.type())
+        {
+            return false;
+        }
+
+        switch (type())
+        {
+            case ValueType::eNull:
+                return true;
+            case ValueType::eBool:
+                return asBool() == other.asBool();
+            case ValueType::eNumber:
+                return asNumber() == other.asNumber();
+            case ValueType::eObject:
+                // Strings are interned, so identity is equality for them as well.
+                return asObject() == other.asObject();
+        }
+
+        return false;
+    }
+
+    auto operator<<(std::ostream& ostr, const Value& value) -> std::ostream&
+    {
+        switch (value.type())
+        {
+            case ValueType::eNull:
+                ostr << "null";
+                break;
+            case ValueType::eBool:
+                ostr << value.asBool();
+                break;
+            case ValueType::eNumber:
+                ostr << value.asNumber();
+                break;
+            case ValueType::eObject:
+            {
+                Object* object = value.asObject();
+                switch (object->type)
+                {
+                    case ObjectType::eBoundMethod:
+                        ostr << "<fn "
+                             << static_cast<Objects::BoundMethod*>(object)->method->function->name
+                             << ">";
+                        break;
+                    case ObjectType::eClass:
+                        ostr << "<fn " << static_cast<Objects::Class*>(object)->name << ">";
+                        break;
+                    case ObjectType::eClosure:
+                        ostr << "<fn " << static_cast<Objects::Closure*>(object)->function->name
+                             << ">";
+                        break;
+                    case ObjectType::eFunction:
+                        ostr << "<fn " << static_cast<Objects::Function*>(object)->name << ">";
+                        break;
+                    case ObjectType::eInstance:
+                        ostr << static_cast<Objects::Instance*>(object)->klass->name
+                             << " instance";
+                        break;
+                    case ObjectType::eNative:
+                        ostr << "<fn " << static_cast<Objects::Native*>(object)->name << ">";
+                        break;
+                    case ObjectType::eString:
+                        ostr << static_cast<Objects::String*>(object)->value;
+                        break;
+                    case ObjectType::eUpvalue:
+                        ostr << "upvalue";
+                        break;
+                }
+                break;
+            }
+        }
+
+        return ostr;
+    }
+}  // namespace sail::Bytecode
@@ -0,0 +1,689 @@
+#include <limits>
+#include <variant>
+
+#include "Compiler/Compiler.h"
+
+#include "Compiler/Peephole.h"
+#include "Errors/CompilerError.h"
+#include "Expressions/Expressions.h"
+#include "Token/Token.h"
+#include "VirtualMachine/VirtualMachine.h"
+#include "utils/Overload.h"
+
+namespace sail
+{
+    using Bytecode::OpCode;
+
+    Compiler::Compiler(VirtualMachine& machine)
+        : _machine(machine)
+    {
+    }
+
+    auto Compiler::compile(std::vector<std::shared_ptr<Statement>>& statements)
+        -> Objects::Function*
+    {
+        Heap& heap = _machine.heap();
+        heap.addRoots(this);
+
+        try
+        {
+            FunctionState script {};
+            beginFunction(script, FunctionType::eNone, "script");
+            for (auto& statement : statements)
+            {
+                compile(statement);
+            }
+
+            Objects::Function* function = endFunction();
+            heap.removeRoots(this);
+            return function;
+        }
+        catch (...)
+        {
+            _current = nullptr;
+            heap.removeRoots(this);
+            throw;
+        }
+    }
+
+    void Compiler::markRoots(Heap& heap)
+    {
+        for (FunctionState* state = _current; state != nullptr; state = state->enclosing)
+        {
+            heap.markObject(state->function);
+        }
+    }
+
+    void Compiler::compile(std::shared_ptr<Statement>& statement)
+    {
+        statement->accept(*this, statement);
+    }
+
+    void Compiler::compile(std::shared_ptr<Expression>& expression)
+    {
+        expression->accept(*this, expression);
+    }
+
+    void Compiler::visitBlockStatement(Statements::Block& blockStatement,
+                                       std::shared_ptr<Statement>& shared)
+    {
+        beginScope();
+        for (auto& statement : blockStatement.statements)
+        {
+            compile(statement);
+        }
+        endScope();
+    }
+
+    void Compiler::visitClassStatement(Statements::Class& classStatement,
+                                       std::shared_ptr<Statement>& shared)
+    {
+        _line = classStatement.name.line;
+        const std::string& name = classStatement.name.lexeme;
+
+        emit(OpCode::eClass);
+        emitShort(identifierConstant(name));
+        declareVariable(name);
+        defineVariable(name);
+
+        ClassState classState {.enclosing = _currentClass};
+        _currentClass = &classState;
+
+        if (classStatement.superclass != nullptr)
+        {
+            std::shared_ptr<Expression> superclass = classStatement.superclass;
+            compile(superclass);
+
+            // Methods capture the superclass through this synthetic local.
+            beginScope();
+            addLocal("super");
+
+            namedVariable(name, false);
+            emit(OpCode::eInherit);
+            classState.hasSuperclass = true;
+        }
+
+        namedVariable(name, false);
+        for (std::shared_ptr<Statements::Function>& method : classStatement.methods)
+        {
+            FunctionType type = FunctionType::eMethod;
+            if (method->possibleInitializer)
+            {
+                type = FunctionType::eInitializer;
+            }
+
+            function(*method, type);
+            emit(OpCode::eMethod);
+            emitShort(identifierConstant(method->name.lexeme));
+        }
+        emit(OpCode::ePop);
+
+        if (classState.hasSuperclass)
+        {
+            endScope();
+        }
+
+        _currentClass = classState.enclosing;
+    }
+
+    void Compiler::visitExpressionStatement(Statements::Expression& expressionStatement,
+                                            std::shared_ptr<Statement>& shared)
+    {
+        if (expressionStatement.tailCall != nullptr)
+        {
+            emitTailCall(*expressionStatement.tailCall, true);
+            emit(OpCode::ePop);
+            return;
+        }
+
+        compile(expressionStatement.expression);
+        emit(OpCode::ePop);
+    }
+
+    void Compiler::visitFunctionStatement(Statements::Function& functionStatement,
+                                          std::shared_ptr<Statement>& shared)
+    {
+        _line = functionStatement.name.line;
+
+        // Locals are declared before the body is compiled so that the function can refer to itself.
+        declareVariable(functionStatement.name.lexeme);
+        function(functionStatement, FunctionType::eFunction);
+        defineVariable(functionStatement.name.lexeme);
+    }
+
+    void Compiler::visitIfStatement(Statements::If& ifStatement, std::shared_ptr<Statement>& shared)
+    {
+        compile(ifStatement.condition);
+
+        size_t thenJump = emitJump(OpCode::eJumpIfFalse);
+        emit(OpCode::ePop);
+        compile(ifStatement.thenBranch);
+
+        size_t elseJump = emitJump(OpCode::eJump);
+        patchJump(thenJump);
+        emit(OpCode::ePop);
+
+        if (ifStatement.elseBranch != nullptr)
+        {
+            compile(ifStatement.elseBranch);
+        }
+        patchJump(elseJump);
+    }
+
+    void Compiler::visitReturnStatement(Statements::Return& returnStatement,
+                                        std::shared_ptr<Statement>& shared)
+    {
+        _line = returnStatement.keyword.line;
+        if (returnStatement.value == nullptr)
+        {
+            emitReturn();
+            return;
+        }
+
+        if (returnStatement.tailCall != nullptr)
+        {
+            emitTailCall(*returnStatement.tailCall, false);
+            emit(OpCode::eReturn);
+            return;
+        }
+
+        compile(returnStatement.value);
+        emit(OpCode::eReturn);
+    }
+
+    void Compiler::visitVariableStatement(Statements::Variable& variableStatement,
+                                          std::shared_ptr<Statement>& shared)
+    {
+        _line = variableStatement.name.line;
+        if (variableStatement.initializer != nullptr) [[likely]]
+        {
+            compile(variableStatement.initializer);
+        }
+        else
+        {
+            emit(OpCode::eNull);
+        }
+
+        declareVariable(variableStatement.name.lexeme);
+        defineVariable(variableStatement.name.lexeme);
+    }
+
+    void Compiler::visitWhileStatement(Statements::While& whileStatement,
+                                       std::shared_ptr<Statement>& shared)
+    {
+        size_t loopStart = chunk().code.size();
+        compile(whileStatement.condition);
+
+        size_t exitJump = emitJump(OpCode::eJumpIfFalse);
+        emit(OpCode::ePop);
+        compile(whileStatement.body);
+        emitLoop(loopStart);
+
+        patchJump(exitJump);
+        emit(OpCode::ePop);
+    }
+
+    void Compiler::visitAssignmentExpression(Expressions::Assignment& assignmentExpression,
+                                             std::shared_ptr<Expression>& shared)
+    {
+        compile(assignmentExpression.value);
+        _line = assignmentExpression.name.line;
+        namedVariable(assignmentExpression.name.lexeme, true);
+    }
+
+    void Compiler::visitBinaryExpression(Expressions::Binary& binaryExpression,
+                                         std::shared_ptr<Expression>& shared)
+    {
+        compile(binaryExpression.left);
+        compile(binaryExpression.right);
+
+        _line = binaryExpression.op.line;
+        switch (binaryExpression.op.type)
+        {
+            case TokenType::eBangEqual:
+                emit(OpCode::eNotEqual);
+                return;
+            case TokenType::eEqualEqual:
+                emit(OpCode::eEqual);
+                return;
+            case TokenType::eGreater:
+                emit(OpCode::eGreater);
+                return;
+            case TokenType::eGreaterEqual:
+                emit(OpCode::eGreaterEqual);
+                return;
+            case TokenType::eLess:
+                emit(OpCode::eLess);
+                return;
+            case TokenType::eLessEqual:
+                emit(OpCode::eLessEqual);
+                return;
+            case TokenType::ePlus:
+                emit(OpCode::eAdd);
+                return;
+            case TokenType::eMinus:
+                emit(OpCode::eSubtract);
+                return;
+            case TokenType::eStar:
+                emit(OpCode::eMultiply);
+                return;
+            case TokenType::eSlash:
+                emit(OpCode::eDivide);
+                return;
+            default:
+                [[unlikely]] break;
+        }
+
+        throw CompilerError("Unknown operator", _line);
+    }
+
+    void Compiler::visitCallExpression(Expressions::Call& callExpression,
+                                       std::shared_ptr<Expression>& shared)
+    {
+        compileCall(callExpression);
+        emit(OpCode::eCall);
+        emitByte(static_cast<uint8_t>(callExpression.arguments.size()));
+    }
+
+    void Compiler::visitGetExpression(Expressions::Get& getExpression,
+                                      std::shared_ptr<Expression>& shared)
+    {
+        compile(getExpression.object);
+
+        _line = getExpression.name.line;
+        emit(OpCode::eGetProperty);
+        emitShort(identifierConstant(getExpression.name.lexeme));
+    }
+
+    void Compiler::visitGroupingExpression(Expressions::Grouping& groupingExpression,
+                                           std::shared_ptr<Expression>& shared)
+    {
+        compile(groupingExpression.expression);
+    }
+
+    void Compiler::visitLiteralExpression(Expressions::Literal& literalExpression,
+                                          std::shared_ptr<Expression>& shared)
+    {
+        std::visit(
+            Overload {
+                [&](const std::string& str) { emitConstant(_machine.intern(str)); },
+                [&](const double& num) { emitConstant(num); },
+                [&](const bool& val) { emit(val ? OpCode::eTrue : OpCode::eFalse); },
+                [&](const Types::Null&) { emit(OpCode::eNull); },
+            },
+            literalExpression.literal);
+    }
+
+    void Compiler::visitLogicalExpression(Expressions::Logical& logicalExpression,
+                                          std::shared_ptr<Expression>& shared)
+    {
+        compile(logicalExpression.left);
+
+        if (logicalExpression.op.type == TokenType::eOr)
+        {
+            size_t elseJump = emitJump(OpCode::eJumpIfFalse);
+            size_t endJump = emitJump(OpCode::eJump);
+
+            patchJump(elseJump);
+            emit(OpCode::ePop);
+            compile(logicalExpression.right);
+            patchJump(endJump);
+            return;
+        }
+
+        size_t endJump = emitJump(OpCode::eJumpIfFalse);
+        emit(OpCode::ePop);
+        compile(logicalExpression.right);
+        patchJump(endJump);
+    }
+
+    void Compiler::visitSetExpression(Expressions::Set& setExpression,
+                                      std::shared_ptr<Expression>& shared)
+    {
+        compile(setExpression.object);
+        compile(setExpression.value);
+
+        _line = setExpression.name.line;
+        emit(OpCode::eSetProperty);
+        emitShort(identifierConstant(setExpression.name.lexeme));
+    }
+
+    void Compiler::visitSuperExpression(Expressions::Super& superExpression,
+                                        std::shared_ptr<Expression>& shared)
+    {
+        _line = superExpression.keyword.line;
+        namedVariable("this", false);
+        namedVariable("super", false);
+
+        emit(OpCode::eGetSuper);
+        emitShort(identifierConstant(superExpression.method.lexeme));
+    }
+
+    void Compiler::visitThisExpression(Expressions::This& thisExpression,
+                                       std::shared_ptr<Expression>& shared)
+    {
+        _line = thisExpression.keyword.line;
+        namedVariable("this", false);
+    }
+
+    void Compiler::visitUnaryExpression(Expressions::Unary& unaryExpression,
+                                        std::shared_ptr<Expression>& shared)
+    {
+        compile(unaryExpression.right);
+
+        _line = unaryExpression.op.line;
+        switch (unaryExpression.op.type)
+        {
+            case TokenType::eMinus:
+                emit(OpCode::eNegate);
+                return;
+            case TokenType::eBang:
+                emit(OpCode::eNot);
+                return;
+            default:
+                [[unlikely]] break;
+        }
+
+        emit(OpCode::ePop);
+        emit(OpCode::eNull);
+    }
+
+    void Compiler::visitVariableExpression(Expressions::Variable& variableExpression,
+                                           std::shared_ptr<Expression>& shared)
+    {
+        _line = variableExpression.name.line;
+        namedVariable(variableExpression.name.lexeme, false);
+    }
+
+    auto Compiler::chunk() -> Bytecode::Chunk&
+    {
+        return _current->function->chunk;
+    }
+
+    void Compiler::emit(OpCode opCode)
+    {
+        chunk().write(opCode, _line);
+    }
+
+    void Compiler::emitByte(uint8_t byte)
+    {
+        chunk().write(byte, _line);
+    }
+
+    void Compiler::emitShort(uint16_t value)
+    {
+        emitByte(static_cast<uint8_t>((value >> 8U) & 0xffU));
+        emitByte(static_cast<uint8_t>(value & 0xffU));
+    }
+
+    void Compiler::emitConstant(Bytecode::Value value)
+    {
+        emit(OpCode::eConstant);
+        emitShort(makeConstant(value));
+    }
+
+    auto Compiler::emitJump(OpCode opCode) -> size_t
+    {
+        emit(opCode);
+        emitShort(0xffff);
+        return chunk().code.size() - 2;
+    }
+
+    void Compiler::patchJump(size_t offset)
+    {
+        size_t jump = chunk().code.size() - offset - 2;
+        if (jump > std::numeric_limits<uint16_t>::max())
+        {
+            throw CompilerError("Too much code to jump over", _line);
+        }
+
+        chunk().code[offset] = static_cast<uint8_t>((jump >> 8U) & 0xffU);
+        chunk().code[offset + 1] = static_cast<uint8_t>(jump & 0xffU);
+    }
+
+    void Compiler::emitLoop(size_t loopStart)
+    {
+        emit(OpCode::eLoop);
+
+        size_t offset = chunk().code.size() - loopStart + 2;
+        if (offset > std::numeric_limits<uint16_t>::max())
+        {
+            throw CompilerError("Loop body too large", _line);
+        }
+        emitShort(static_cast<uint16_t>(offset));
+    }
+
+    void Compiler::emitReturn()
+    {
+        if (_current->type == FunctionType::eInitializer)
+        {
+            emit(OpCode::eGetLocal);
+            emitByte(0);
+        }
+        else
+        {
+            emit(OpCode::eNull);
+        }
+
+        emit(OpCode::eReturn);
+    }
+
+    void Compiler::compileCall(Expressions::Call& callExpression)
+    {
+        compile(callExpression.callee);
+        for (auto& argument : callExpression.arguments)
+        {
+            compile(argument);
+        }
+
+        _line = callExpression.paren.line;
+        if (callExpression.arguments.size() > std::numeric_limits<uint8_t>::max())
+        {
+            throw CompilerError("Cannot have more than 255 arguments", _line);
+        }
+    }
+
+    void Compiler::emitTailCall(Expressions::Call& callExpression, bool discardResult)
+    {
+        compileCall(callExpression);
+        emit(OpCode::eTailCall);
+        emitByte(static_cast<uint8_t>(callExpression.arguments.size()));
+        emitByte(discardResult ? 1 : 0);
+    }
+
+    auto Compiler::makeConstant(Bytecode::Value value) -> uint16_t
+    {
+        size_t constant = chunk().addConstant(value);
+        _machine.heap().writeBarrier(_current->function, value);
+        if (constant > std::numeric_limits<uint16_t>::max())
+        {
+            throw CompilerError("Too many constants in one chunk", _line);
+        }
+
+        return static_cast<uint16_t>(constant);
+    }
+
+    auto Compiler::identifierConstant(const std::string& name) -> uint16_t
+    {
+        return makeConstant(_machine.intern(name));
+    }
+
+    void Compiler::beginFunction(FunctionState& state, FunctionType type, const std::string& name)
+    {
+        state.enclosing = _current;
+        state.function = _machine.allocate<Objects::Function>(name);
+        state.type = type;
+
+        // Slot zero holds the callee, or the receiver for methods.
+        bool isMethod = type == FunctionType::eMethod || type == FunctionType::eInitializer;
+        state.locals.push_back({.name = isMethod ? "this" : "", .depth = 0});
+
+        _current = &state;
+    }
+
+    auto Compiler::endFunction() -> Objects::Function*
+    {
+        emitReturn();
+
+        Objects::Function* function = _current->function;
+        fuseSuperinstructions(function->chunk);
+        function->upvalueCount = _current->upvalues.size();
+        _current = _current->enclosing;
+        return function;
+    }
+
+    void Compiler::function(Statements::Function& functionStatement, FunctionType type)
+    {
+        FunctionState state {};
+        beginFunction(state, type, functionStatement.name.lexeme);
+        beginScope();
+
+        for (Token& parameter : functionStatement.parameters)
+        {
+            _current->function->arity++;
+            addLocal(parameter.lexeme);
+        }
+
+        for (auto& statement : functionStatement.body)
+        {
+            compile(statement);
+        }
+
+        Objects::Function* compiled = endFunction();
+
+        _line = functionStatement.name.line;
+        emit(OpCode::eClosure);
+        emitShort(makeConstant(compiled));
+        for (const Upvalue& upvalue : state.upvalues)
+        {
+            emitByte(upvalue.isLocal ? 1 : 0);
+            emitByte(upvalue.index);
+        }
+    }
+
+    void Compiler::beginScope()
+    {
+        _current->scopeDepth++;
+    }
+
+    void Compiler::endScope()
+    {
+        _current->scopeDepth--;
+
+        std::vector<Local>& locals = _current->locals;
+        while (!locals.empty() && locals.back().depth > _current->scopeDepth)
+        {
+            emit(locals.back().isCaptured ? OpCode::eCloseUpvalue : OpCode::ePop);
+            locals.pop_back();
+        }
+    }
+
+    void Compiler::addLocal(const std::string& name)
+    {
+        if (_current->locals.size() > std::numeric_limits<uint8_t>::max())
+        {
+            throw CompilerError("Too many local variables in function", _line);
+        }
+
+        _current->locals.push_back({.name = name, .depth = _current->scopeDepth});
+    }
+
+    void Compiler::declareVariable(const std::string& name)
+    {
+        if (_current->scopeDepth == 0)
+        {
+            return;
+        }
+
+        addLocal(name);
+    }
+
+    void Compiler::defineVariable(const std::string& name)
+    {
+        if (_current->scopeDepth > 0)
+        {
+            // The value is already sitting in the local's slot.
+            return;
+        }
+
+        emit(OpCode::eDefineGlobal);
+        emitShort(_machine.globalSlot(name));
+    }
+
+    void Compiler::namedVariable(const std::string& name, bool assign)
+    {
+        int local = resolveLocal(*_current, name);
+        if (local != -1)
+        {
+            emit(assign ? OpCode::eSetLocal : OpCode::eGetLocal);
+            emitByte(static_cast<uint8_t>(local));
+            return;
+        }
+
+        int upvalue = resolveUpvalue(*_current, name);
+        if (upvalue != -1)
+        {
+            emit(assign ? OpCode::eSetUpvalue : OpCode::eGetUpvalue);
+            emitByte(static_cast<uint8_t>(upvalue));
+            return;
+        }
+
+        emit(assign ? OpCode::eSetGlobal : OpCode::eGetGlobal);
+        emitShort(_machine.globalSlot(name));
+    }
+
+    auto Compiler::resolveLocal(FunctionState& state, const std::string& name) -> int
+    {
+        for (auto i = static_cast<int>(state.locals.size()) - 1; i >= 0; i--)
+        {
+            if (state.locals[i].name == name)
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    auto Compiler::resolveUpvalue(FunctionState& state, const std::string& name) -> int
+    {
+        if (state.enclosing == nullptr)
+        {
+            return -1;
+        }
+
+        int local = resolveLocal(*state.enclosing, name);
+        if (local != -1)
+        {
+            state.enclosing->locals[local].isCaptured = true;
+            return addUpvalue(state, static_cast<uint8_t>(local), true);
+        }
+
+        int upvalue = resolveUpvalue(*state.enclosing, name);
+        if (upvalue != -1)
+        {
+            return addUpvalue(state, static_cast<uint8_t>(upvalue), false);
+        }
+
+        return -1;
+    }
+
+    auto Compiler::addUpvalue(FunctionState& state, uint8_t index, bool isLocal) -> int
+    {
+        for (size_t i = 0; i < state.upvalues.size(); i++)
+        {
+            if (state.upvalues[i].index == index && state.upvalues[i].isLocal == isLocal)
+            {
+                return static_cast<int>(i);
+            }
+        }
+
+        if (state.upvalues.size() > std::numeric_limits<uint8_t>::max())
+        {
+            throw CompilerError("Too many closure variables in function", _line);
+        }
+
+        state.upvalues.push_back({.index = index, .isLocal = isLocal});
+        return static_cast<int>(state.upvalues.size() - 1);
+    }
+}  // namespace sail
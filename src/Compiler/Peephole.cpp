@@ -0,0 +1,188 @@
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#include "Compiler/Peephole.h"
+
+namespace sail
+{
+    using Bytecode::OpCode;
+
+    namespace
+    {
+        struct Instruction
+        {
+            OpCode opCode;
+            size_t offset;
+            size_t length;
+        };
+
+        // A jump operand in the rewritten code, waiting for the new offset of its target.
+        struct PendingJump
+        {
+            size_t operand;
+            size_t target;
+            bool backward;
+        };
+
+        auto readShort(const Bytecode::Chunk& chunk, size_t offset) -> uint16_t
+        {
+            return static_cast<uint16_t>((chunk.code[offset] << 8U) | chunk.code[offset + 1]);
+        }
+
+        auto isJump(OpCode opCode) -> bool
+        {
+            return opCode == OpCode::eJump || opCode == OpCode::eJumpIfFalse
+                   || opCode == OpCode::eLoop || opCode == OpCode::eLessJumpIfFalse
+                   || opCode == OpCode::eGreaterJumpIfFalse;
+        }
+
+        auto jumpTarget(const Bytecode::Chunk& chunk, const Instruction& jump) -> size_t
+        {
+            size_t next = jump.offset + jump.length;
+            uint16_t distance = readShort(chunk, jump.offset + 1);
+            return jump.opCode == OpCode::eLoop ? next - distance : next + distance;
+        }
+    }  // namespace
+
+    void fuseSuperinstructions(Bytecode::Chunk& chunk)
+    {
+        std::vector<Instruction> instructions;
+        for (size_t offset = 0; offset < chunk.code.size();)
+        {
+            Instruction instruction {.opCode = static_cast<OpCode>(chunk.code[offset]),
+                                     .offset = offset,
+                                     .length = chunk.instructionLength(offset)};
+            instructions.push_back(instruction);
+            offset += instruction.length;
+        }
+
+        std::vector<bool> isTarget(chunk.code.size() + 1);
+        for (const Instruction& instruction : instructions)
+        {
+            if (isJump(instruction.opCode))
+            {
+                isTarget[jumpTarget(chunk, instruction)] = true;
+            }
+        }
+
+        auto matches = [&](size_t first, std::initializer_list<OpCode> opCodes) -> bool
+        {
+            if (first + opCodes.size() > instructions.size())
+            {
+                return false;
+            }
+
+            size_t index = first;
+            for (OpCode opCode : opCodes)
+            {
+                const Instruction& instruction = instructions[index];
+                bool jumpedInto = index != first && isTarget[instruction.offset];
+                if (instruction.opCode != opCode || jumpedInto)
+                {
+                    return false;
+                }
+                index++;
+            }
+            return true;
+        };
+        auto operand = [&](size_t index) -> uint8_t
+        { return chunk.code[instructions[index].offset + 1]; };
+
+        std::vector<uint8_t> code;
+        std::vector<size_t> lines;
+        std::vector<size_t> newOffsets(chunk.code.size() + 1);
+        std::vector<PendingJump> jumps;
+
+        size_t line = 0;
+        auto emit = [&](uint8_t byte)
+        {
+            code.push_back(byte);
+            lines.push_back(line);
+        };
+        auto emitOpCode = [&](OpCode opCode) { emit(static_cast<uint8_t>(opCode)); };
+        auto emitJump = [&](size_t target, bool backward)
+        {
+            jumps.push_back({.operand = code.size(), .target = target, .backward = backward});
+            emit(0xff);
+            emit(0xff);
+        };
+        auto copy = [&](const Instruction& instruction, size_t from, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                emit(chunk.code[instruction.offset + from + i]);
+            }
+        };
+
+        size_t index = 0;
+        while (index < instructions.size())
+        {
+            const Instruction& instruction = instructions[index];
+            newOffsets[instruction.offset] = code.size();
+            line = chunk.lines[instruction.offset];
+
+            if (matches(index,
+                        {OpCode::eGetLocal,
+                         OpCode::eConstant,
+                         OpCode::eAdd,
+                         OpCode::eSetLocal,
+                         OpCode::ePop})
+                && operand(index) == operand(index + 3)
+                && chunk.constants[readShort(chunk, instructions[index + 1].offset + 1)].isNumber())
+            {
+                emitOpCode(OpCode::eIncrementLocal);
+                copy(instruction, 1, 1);
+                copy(instructions[index + 1], 1, 2);
+                index += 5;
+            }
+            else if (matches(index, {OpCode::eGetLocal, OpCode::eConstant}))
+            {
+                emitOpCode(OpCode::eGetLocalConstant);
+                copy(instruction, 1, 1);
+                copy(instructions[index + 1], 1, 2);
+                index += 2;
+            }
+            else if (matches(index, {OpCode::eSetLocal, OpCode::ePop}))
+            {
+                emitOpCode(OpCode::eSetLocalPop);
+                copy(instruction, 1, 1);
+                index += 2;
+            }
+            else if (matches(index, {OpCode::eLess, OpCode::eJumpIfFalse, OpCode::ePop})
+                     || matches(index, {OpCode::eGreater, OpCode::eJumpIfFalse, OpCode::ePop}))
+            {
+                emitOpCode(instruction.opCode == OpCode::eLess ? OpCode::eLessJumpIfFalse
+                                                               : OpCode::eGreaterJumpIfFalse);
+                emitJump(jumpTarget(chunk, instructions[index + 1]), false);
+                index += 3;
+            }
+            else if (isJump(instruction.opCode))
+            {
+                emitOpCode(instruction.opCode);
+                emitJump(jumpTarget(chunk, instruction), instruction.opCode == OpCode::eLoop);
+                index++;
+            }
+            else
+            {
+                copy(instruction, 0, instruction.length);
+                index++;
+            }
+        }
+        newOffsets[chunk.code.size()] = code.size();
+
+        // Fusing only ever shrinks the code, so every distance still fits its operand.
+        for (const PendingJump& jump : jumps)
+        {
+            size_t next = jump.operand + 2;
+            size_t target = newOffsets[jump.target];
+            size_t distance = jump.backward ? next - target : target - next;
+            code[jump.operand] = static_cast<uint8_t>((distance >> 8U) & 0xffU);
+            code[jump.operand + 1] = static_cast<uint8_t>(distance & 0xffU);
+        }
+
+        chunk.code = std::move(code);
+        chunk.lines = std::move(lines);
+    }
+}  // namespace sail
@@ -45,16 +45,6 @@ namespace sail
                            fmt::format("Attempted to get undefined variable '{}'", name.lexeme));
     }
 
-    auto Environment::getAt(size_t distance, const std::string& name) -> Value&
-    {
-        return ancestor(distance)->_values[name];
-    }
-
-    auto Environment::getAt(size_t distance, const Token& name) -> Value&
-    {
-        return ancestor(distance)->_values[name.lexeme];
-    }
-
     void Environment::define(const std::string& name, const Value& value)
     {
         _values[name] = value;
@@ -84,22 +74,6 @@ namespace sail
                            fmt::format("Attempted to assign undefined variable '{}'", name.lexeme));
     }
 
-    void Environment::assignAt(size_t distance, const Token& name, const Value& value)
-    {
-        ancestor(distance)->assign(name, value);
-    }
-
-    auto Environment::ancestor(size_t distance) -> Environment*
-    {
-        auto* environment = this;
-        for (size_t i = 0; i < distance; i++)
-        {
-            environment = environment->_enclosing.get();
-        }
-
-        return environment;
-    }
-
     void Environment::reset()
     {
         _values.clear();
@@ -0,0 +1,16 @@
+#include "Errors/CompilerError.h"
+
+#include "fmt/format.h"
+
+namespace sail
+{
+    CompilerError::CompilerError(const std::string& message, size_t line)
+    {
+        _message = fmt::format("Compile error at line {}: {}", line, message);
+    }
+
+    auto CompilerError::what() const noexcept -> const char*
+    {
+        return _message.c_str();
+    }
+}  // namespace sail
@@ -10,6 +10,11 @@ namespace sail
             fmt::format("Runtime error at line {}: {}", token.line, message);
     }
 
+    RuntimeError::RuntimeError(size_t line, const std::string& message)
+    {
+        _message = fmt::format("Runtime error at line {}: {}", line, message);
+    }
+
     auto RuntimeError::what() const noexcept -> const char*
     {
         return _message.c_str();
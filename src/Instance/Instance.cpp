@@ -3,21 +3,39 @@
 
 #include "Instance/Instance.h"
 
+#include "Compiler/Compiler.h"
+#include "Interpreter/ClosureCompiler.h"
 #include "Interpreter/Interpreter.h"
+#include "Optimizer/Optimizer.h"
 #include "Parser/Parser.h"
 #include "Resolver/Resolver.h"
 #include "Scanner/Scanner.h"
+#include "VirtualMachine/VirtualMachine.h"
 #include "mimalloc-new-delete.h"
 
 namespace sail
 {
-    Instance::Instance()
-        : _interpreter(new Interpreter())
+    Instance::Instance(InstanceOptions options)
+        : _options(options)
     {
+        // Only the engine the mode runs on is built.
+        if (_options.mode != ExecutionMode::eBytecode)
+        {
+            _interpreter = new Interpreter(_selectors, _options.maxCallDepth);
+            return;
+        }
+
+        _machine = new VirtualMachine(_options.maxCallDepth);
+        _machine->heap().setSliceBudget(_options.gcSliceBudget);
+        if (_options.jit)
+        {
+            _machine->enableJit(_options.jitThreshold, _options.jitLoopThreshold);
+        }
     }
 
     Instance::~Instance()
     {
+        delete _machine;
         delete _interpreter;
     }
 
@@ -50,22 +68,43 @@ namespace sail
         {
             std::cout << "> ";
             std::string source;
-            std::getline(std::cin, source);
-
-            if (source == "exit")
+            if (!std::getline(std::cin, source) || source == "exit")
             {
                 break;
             }
 
-            // try
-            // {
-            run(source);
-            // }
-            // catch (const std::exception& e)
-            // {
-            //     std::cout << e.what() << std::endl;
-            // }
+            // An error only ends the line it came from, so the prompt carries on after it.
+            try
+            {
+                run(source);
+            }
+            catch (const std::exception& e)
+            {
+                std::cout << e.what() << std::endl;
+            }
+        }
+    }
+
+    auto Instance::heapStatistics() const -> const HeapStatistics&
+    {
+        static const HeapStatistics kNoStatistics;
+
+        if (_machine == nullptr)
+        {
+            return kNoStatistics;
         }
+        return _machine->heap().statistics();
+    }
+
+    auto Instance::dispatchStatistics() const -> const DispatchStatistics&
+    {
+        static const DispatchStatistics kNoStatistics;
+
+        if (_machine == nullptr)
+        {
+            return kNoStatistics;
+        }
+        return _machine->dispatchStatistics();
     }
 
     void Instance::run(const std::string& source)
@@ -77,10 +116,34 @@ namespace sail
         Parser parser {tokens};
         std::vector<std::shared_ptr<Statement>> statements = parser.parse();
 
-        Resolver resolver {*_interpreter};
+        Resolver resolver {_selectors};
         resolver.resolve(statements);
 
-        _interpreter->interpret(statements);
+        if (_options.optimize)
+        {
+            Optimizer optimizer;
+            optimizer.optimize(statements);
+        }
+
+        switch (_options.mode)
+        {
+            case ExecutionMode::eBytecode:
+            {
+                Compiler compiler {*_machine};
+                Objects::Function* script = compiler.compile(statements);
+                _machine->interpret(script);
+                break;
+            }
+            case ExecutionMode::eTreeWalk:
+                _interpreter->interpret(statements);
+                break;
+            case ExecutionMode::eClosures:
+            {
+                ClosureCompiler compiler;
+                _interpreter->interpret(compiler.compile(statements));
+                break;
+            }
+        }
 
         // end here
     }
@@ -0,0 +1,871 @@
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <variant>
+
+#include "Interpreter/ClosureCompiler.h"
+
+#include "Errors/RuntimeError.h"
+#include "Expressions/Expressions.h"
+#include "Statements/Statements.h"
+#include "Types/Types.h"
+#include "Types/Value.h"
+
+namespace sail
+{
+    namespace
+    {
+        // Arithmetic and comparisons once both operands are numbers.
+        auto applyNumberOperator(const Token& op, double left, double right) -> Value
+        {
+            switch (op.type)
+            {
+                case TokenType::eMinus:
+                    return left - right;
+                case TokenType::eSlash:
+                    return left / right;
+                case TokenType::eStar:
+                    return left * right;
+                case TokenType::ePlus:
+                    return left + right;
+                case TokenType::eGreater:
+                    return left > right;
+                case TokenType::eGreaterEqual:
+                    return left >= right;
+                case TokenType::eLess:
+                    return left < right;
+                case TokenType::eLessEqual:
+                    return left <= right;
+                case TokenType::eEqualEqual:
+                    return left == right;
+                case TokenType::eBangEqual:
+                    return left != right;
+                default:
+                    [[unlikely]] break;
+            }
+
+            throw RuntimeError(op, "Unknown operator");
+        }
+
+        // The Interpreter's rules for operands that are not both numbers.
+        auto applyOperator(const Token& op, const Value& left, const Value& right) -> Value
+        {
+            if (op.type == TokenType::ePlus && left.isString() && right.isString())
+            {
+                return std::get<std::string>(left) + std::get<std::string>(right);
+            }
+            if (op.type == TokenType::eBangEqual)
+            {
+                return left != right;
+            }
+            if (op.type == TokenType::eEqualEqual)
+            {
+                return left == right;
+            }
+
+            std::optional<double> leftNumber = left.asNumber();
+            std::optional<double> rightNumber = right.asNumber();
+            if (!leftNumber.has_value() || !rightNumber.has_value()) [[unlikely]]
+            {
+                throw RuntimeError(op, "Cannot perform arithmetic on non-numbers");
+            }
+
+            return applyNumberOperator(op, *leftNumber, *rightNumber);
+        }
+
+        template<typename Operation>
+        auto binary(const Token& op, CompiledExpression left, CompiledExpression right)
+            -> CompiledExpression
+        {
+            return [op, left = std::move(left), right = std::move(right)](
+                       Interpreter& interpreter) -> Value
+            {
+                Value leftValue = left(interpreter);
+                Value rightValue = right(interpreter);
+
+                const double* leftNumber = std::get_if<double>(&leftValue);
+                const double* rightNumber = std::get_if<double>(&rightValue);
+                if (leftNumber != nullptr && rightNumber != nullptr) [[likely]]
+                {
+                    return Operation {}(*leftNumber, *rightNumber);
+                }
+                return applyOperator(op, leftValue, rightValue);
+            };
+        }
+
+        auto sequence(std::vector<CompiledStatement> statements) -> CompiledStatement
+        {
+            return [statements = std::move(statements)](Interpreter& interpreter) -> Completion
+            {
+                for (const CompiledStatement& statement : statements)
+                {
+                    if (statement(interpreter) == Completion::eReturn)
+                    {
+                        return Completion::eReturn;
+                    }
+                }
+                return Completion::eNormal;
+            };
+        }
+    }  // namespace
+
+    auto ClosureCompiler::compile(std::vector<std::shared_ptr<Statement>>& statements)
+        -> CompiledStatement
+    {
+        std::vector<CompiledStatement> compiled;
+        compiled.reserve(statements.size());
+        for (auto& statement : statements)
+        {
+            compiled.push_back(compile(statement));
+        }
+        return sequence(std::move(compiled));
+    }
+
+    auto ClosureCompiler::compile(std::shared_ptr<Statement>& statement) -> CompiledStatement
+    {
+        statement->accept(*this, statement);
+        return std::move(_statement);
+    }
+
+    auto ClosureCompiler::compile(std::shared_ptr<Expression>& expression) -> CompiledExpression
+    {
+        expression->accept(*this, expression);
+        return std::move(_expression);
+    }
+
+    auto ClosureCompiler::compileAll(std::vector<std::shared_ptr<Expression>>& expressions)
+        -> std::vector<CompiledExpression>
+    {
+        std::vector<CompiledExpression> compiled;
+        compiled.reserve(expressions.size());
+        for (auto& expression : expressions)
+        {
+            compiled.push_back(compile(expression));
+        }
+        return compiled;
+    }
+
+    auto ClosureCompiler::compileBody(Statements::Function& functionStatement)
+        -> std::shared_ptr<const CompiledStatement>
+    {
+        return std::make_shared<const CompiledStatement>(compile(functionStatement.body));
+    }
+
+    auto ClosureCompiler::load(const Token& name, const Expressions::Binding& binding)
+        -> CompiledExpression
+    {
+        const size_t slot = binding.slot;
+        switch (binding.kind)
+        {
+            case Expressions::BindingKind::eLocal:
+                return [slot](Interpreter& interpreter) -> Value
+                { return interpreter._stack[interpreter._frameBase + slot]; };
+            case Expressions::BindingKind::eUpvalue:
+                return [slot](Interpreter& interpreter) -> Value
+                { return interpreter.upvalue(slot); };
+            case Expressions::BindingKind::eGlobal:
+                break;
+        }
+        return [name](Interpreter& interpreter) -> Value
+        { return interpreter._globalEnvironment->get(name); };
+    }
+
+    auto ClosureCompiler::declare(const Token& name, const Expressions::Binding& binding)
+        -> std::function<void(Interpreter&, Value)>
+    {
+        if (binding.kind == Expressions::BindingKind::eLocal)
+        {
+            const size_t slot = binding.slot;
+            return [slot](Interpreter& interpreter, Value value)
+            { interpreter._stack[interpreter._frameBase + slot] = std::move(value); };
+        }
+        return [name](Interpreter& interpreter, Value value)
+        { interpreter._globalEnvironment->define(name, value); };
+    }
+
+    template<typename Call>
+    auto ClosureCompiler::withArguments(Interpreter& interpreter,
+                                        const std::vector<CompiledExpression>& arguments,
+                                        Call&& call) -> Value
+    {
+        std::vector<Value>& stack = interpreter._stack;
+        size_t base = stack.size();
+        Value result;
+        try
+        {
+            for (const CompiledExpression& argument : arguments)
+            {
+                stack.push_back(argument(interpreter));
+            }
+            result = call(std::span<Value>(stack).subspan(base));
+        }
+        catch (...)
+        {
+            stack.resize(base);
+            throw;
+        }
+
+        stack.resize(base);
+        return result;
+    }
+
+    auto ClosureCompiler::callValue(Interpreter& interpreter,
+                                    const Expressions::Call& callExpression,
+                                    const std::vector<CompiledExpression>& arguments,
+                                    const Value& callee) -> Value
+    {
+        return withArguments(
+            interpreter,
+            arguments,
+            [&](std::span<Value> values) -> Value
+            {
+                const auto* callable = std::get_if<std::shared_ptr<Types::Callable>>(&callee);
+                if (callable == nullptr || *callable == nullptr) [[unlikely]]
+                {
+                    throw RuntimeError(callExpression.paren,
+                                       "Can only call functions and classes");
+                }
+
+                Interpreter::checkArity(callExpression, (*callable)->arity(), values.size());
+                return (*callable)->call(interpreter, values);
+            });
+    }
+
+    auto ClosureCompiler::compileTailCall(Expressions::Call& callExpression, bool discardResult)
+        -> CompiledStatement
+    {
+        std::vector<CompiledExpression> arguments = compileAll(callExpression.arguments);
+        if (callExpression.property == nullptr)
+        {
+            return [&callExpression,
+                    discardResult,
+                    callee = compile(callExpression.callee),
+                    arguments = std::move(arguments)](Interpreter& interpreter) -> Completion
+            {
+                Value calleeValue = callee(interpreter);
+                Interpreter::TailCall target {.discardResult = discardResult};
+                Interpreter::tailCallTarget(calleeValue, target);
+                if (target.function == nullptr)
+                {
+                    return completeCall(
+                        interpreter,
+                        callValue(interpreter, callExpression, arguments, calleeValue),
+                        discardResult);
+                }
+                return tailCall(interpreter, callExpression, arguments, std::move(target));
+            };
+        }
+
+        Expressions::Get& property = *callExpression.property;
+        return [&callExpression,
+                &property,
+                discardResult,
+                object = compile(property.object),
+                arguments = std::move(arguments)](Interpreter& interpreter) -> Completion
+        {
+            Value objectValue = object(interpreter);
+            auto* instance = std::get_if<std::shared_ptr<Types::Instance>>(&objectValue);
+            if (instance == nullptr) [[unlikely]]
+            {
+                throw RuntimeError(property.name, "Only instances have properties");
+            }
+
+            const Expressions::PropertyCacheEntry& entry =
+                interpreter.lookupProperty(property, **instance);
+            Interpreter::TailCall target {.function = entry.method.lock(),
+                                          .discardResult = discardResult};
+            if (target.function != nullptr)
+            {
+                target.instance = *instance;
+                return tailCall(interpreter, callExpression, arguments, std::move(target));
+            }
+
+            Value callee = (*instance)->get(entry);
+            Interpreter::tailCallTarget(callee, target);
+            if (target.function == nullptr)
+            {
+                return completeCall(interpreter,
+                                    callValue(interpreter, callExpression, arguments, callee),
+                                    discardResult);
+            }
+            return tailCall(interpreter, callExpression, arguments, std::move(target));
+        };
+    }
+
+    auto ClosureCompiler::tailCall(Interpreter& interpreter,
+                                   const Expressions::Call& callExpression,
+                                   const std::vector<CompiledExpression>& arguments,
+                                   Interpreter::TailCall target) -> Completion
+    {
+        // Left on the stack when an argument throws, for callFunction to drop with the frame.
+        const size_t base = interpreter._stack.size();
+        for (const CompiledExpression& argument : arguments)
+        {
+            interpreter._stack.push_back(argument(interpreter));
+        }
+
+        return interpreter.scheduleTailCall(callExpression, std::move(target), base);
+    }
+
+    auto ClosureCompiler::completeCall(Interpreter& interpreter, Value result, bool discardResult)
+        -> Completion
+    {
+        if (discardResult)
+        {
+            return Completion::eNormal;
+        }
+
+        interpreter._returnValue = std::move(result);
+        return Completion::eReturn;
+    }
+
+    void ClosureCompiler::visitBlockStatement(Statements::Block& blockStatement,
+                                              std::shared_ptr<Statement>& shared)
+    {
+        CompiledStatement statements = compile(blockStatement.statements);
+        const size_t firstSlot = blockStatement.firstSlot;
+        const size_t slotCount = blockStatement.slotCount;
+
+        if (!blockStatement.closesUpvalues)
+        {
+            _statement = [statements = std::move(statements), firstSlot, slotCount](
+                             Interpreter& interpreter) -> Completion
+            {
+                const size_t first = interpreter._frameBase + firstSlot;
+                if (interpreter._stack.size() < first + slotCount)
+                {
+                    interpreter._stack.resize(first + slotCount);
+                }
+                return statements(interpreter);
+            };
+            return;
+        }
+
+        _statement = [statements = std::move(statements), firstSlot, slotCount](
+                         Interpreter& interpreter) -> Completion
+        {
+            const size_t first = interpreter._frameBase + firstSlot;
+            if (interpreter._stack.size() < first + slotCount)
+            {
+                interpreter._stack.resize(first + slotCount);
+            }
+
+            Completion completion;
+            try
+            {
+                completion = statements(interpreter);
+            }
+            catch (...)
+            {
+                interpreter.closeUpvalues(first);
+                throw;
+            }
+            interpreter.closeUpvalues(first);
+            return completion;
+        };
+    }
+
+    void ClosureCompiler::visitClassStatement(Statements::Class& classStatement,
+                                              std::shared_ptr<Statement>& shared)
+    {
+        std::optional<CompiledExpression> superclassExpression;
+        if (classStatement.superclass != nullptr)
+        {
+            superclassExpression =
+                load(classStatement.superclass->name, classStatement.superclass->binding);
+        }
+
+        std::vector<std::shared_ptr<const CompiledStatement>> bodies;
+        for (std::shared_ptr<Statements::Function>& method : classStatement.methods)
+        {
+            bodies.push_back(compileBody(*method));
+        }
+
+        _statement = [&classStatement,
+                      superclassExpression = std::move(superclassExpression),
+                      bodies = std::move(bodies),
+                      declare = declare(classStatement.name, classStatement.binding)](
+                         Interpreter& interpreter) -> Completion
+        {
+            std::shared_ptr<Types::Class> superclass = nullptr;
+            if (superclassExpression.has_value())
+            {
+                Value value = (*superclassExpression)(interpreter);
+                auto* superclassCallable = std::get_if<std::shared_ptr<Types::Callable>>(&value);
+                if (superclassCallable == nullptr) [[unlikely]]
+                {
+                    throw RuntimeError(classStatement.superclass->name,
+                                       "Superclass must be a class (1)");
+                }
+
+                superclass = std::dynamic_pointer_cast<Types::Class>(*superclassCallable);
+                if (!superclass) [[unlikely]]
+                {
+                    throw RuntimeError(classStatement.superclass->name,
+                                       "Superclass must be a class (2)");
+                }
+            }
+
+            declare(interpreter, Types::Null {});
+
+            std::vector<std::shared_ptr<Types::Function>> methods;
+            for (size_t i = 0; i < classStatement.methods.size(); i++)
+            {
+                std::shared_ptr<Statements::Function>& method = classStatement.methods[i];
+                methods.push_back(
+                    std::make_shared<Types::Function>(method,
+                                                      interpreter.captureUpvalues(*method),
+                                                      method->possibleInitializer,
+                                                      superclass,
+                                                      bodies[i]));
+            }
+
+            declare(interpreter,
+                    std::make_shared<Types::Class>(
+                        classStatement.name.lexeme, superclass, methods));
+            return Completion::eNormal;
+        };
+    }
+
+    void ClosureCompiler::visitExpressionStatement(Statements::Expression& expressionStatement,
+                                                   std::shared_ptr<Statement>& shared)
+    {
+        if (expressionStatement.tailCall != nullptr)
+        {
+            _statement = compileTailCall(*expressionStatement.tailCall, true);
+            return;
+        }
+
+        _statement = [expression = compile(expressionStatement.expression)](
+                         Interpreter& interpreter) -> Completion
+        {
+            expression(interpreter);
+            return Completion::eNormal;
+        };
+    }
+
+    void ClosureCompiler::visitFunctionStatement(Statements::Function& functionStatement,
+                                                 std::shared_ptr<Statement>& shared)
+    {
+        _statement = [declaration = std::dynamic_pointer_cast<Statements::Function>(shared),
+                      body = compileBody(functionStatement),
+                      declare = declare(functionStatement.name, functionStatement.binding)](
+                         Interpreter& interpreter) -> Completion
+        {
+            auto function = std::make_shared<Types::Function>(
+                declaration, interpreter.captureUpvalues(*declaration), false, nullptr, body);
+            declare(interpreter, std::move(function));
+            return Completion::eNormal;
+        };
+    }
+
+    void ClosureCompiler::visitIfStatement(Statements::If& ifStatement,
+                                           std::shared_ptr<Statement>& shared)
+    {
+        CompiledExpression condition = compile(ifStatement.condition);
+        CompiledStatement thenBranch = compile(ifStatement.thenBranch);
+        if (ifStatement.elseBranch == nullptr)
+        {
+            _statement = [condition = std::move(condition), thenBranch = std::move(thenBranch)](
+                             Interpreter& interpreter) -> Completion
+            {
+                if (condition(interpreter).isTruthy())
+                {
+                    return thenBranch(interpreter);
+                }
+                return Completion::eNormal;
+            };
+            return;
+        }
+
+        _statement = [condition = std::move(condition),
+                      thenBranch = std::move(thenBranch),
+                      elseBranch = compile(ifStatement.elseBranch)](
+                         Interpreter& interpreter) -> Completion
+        {
+            if (condition(interpreter).isTruthy())
+            {
+                return thenBranch(interpreter);
+            }
+            return elseBranch(interpreter);
+        };
+    }
+
+    void ClosureCompiler::visitReturnStatement(Statements::Return& returnStatement,
+                                               std::shared_ptr<Statement>& shared)
+    {
+        if (returnStatement.tailCall != nullptr)
+        {
+            _statement = compileTailCall(*returnStatement.tailCall, false);
+            return;
+        }
+
+        if (returnStatement.value == nullptr)
+        {
+            _statement = [](Interpreter& interpreter) -> Completion
+            {
+                interpreter._returnValue = Types::Null {};
+                return Completion::eReturn;
+            };
+            return;
+        }
+
+        // The value is only parked in the Interpreter for the call to take, as in tree-walking.
+        _statement = [value = compile(returnStatement.value)](
+                         Interpreter& interpreter) -> Completion
+        {
+            interpreter._returnValue = value(interpreter);
+            return Completion::eReturn;
+        };
+    }
+
+    void ClosureCompiler::visitVariableStatement(Statements::Variable& variableStatement,
+                                                 std::shared_ptr<Statement>& shared)
+    {
+        auto declare = ClosureCompiler::declare(variableStatement.name, variableStatement.binding);
+        if (variableStatement.initializer == nullptr)
+        {
+            _statement = [declare = std::move(declare)](Interpreter& interpreter) -> Completion
+            {
+                declare(interpreter, Types::Null {});
+                return Completion::eNormal;
+            };
+            return;
+        }
+
+        _statement = [initializer = compile(variableStatement.initializer),
+                      declare = std::move(declare)](Interpreter& interpreter) -> Completion
+        {
+            declare(interpreter, initializer(interpreter));
+            return Completion::eNormal;
+        };
+    }
+
+    void ClosureCompiler::visitWhileStatement(Statements::While& whileStatement,
+                                              std::shared_ptr<Statement>& shared)
+    {
+        _statement = [condition = compile(whileStatement.condition),
+                      body = compile(whileStatement.body)](Interpreter& interpreter) -> Completion
+        {
+            while (condition(interpreter).isTruthy())
+            {
+                if (body(interpreter) == Completion::eReturn)
+                {
+                    return Completion::eReturn;
+                }
+            }
+            return Completion::eNormal;
+        };
+    }
+
+    void ClosureCompiler::visitAssignmentExpression(Expressions::Assignment& assignmentExpression,
+                                                    std::shared_ptr<Expression>& shared)
+    {
+        CompiledExpression value = compile(assignmentExpression.value);
+        const size_t slot = assignmentExpression.binding.slot;
+        switch (assignmentExpression.binding.kind)
+        {
+            case Expressions::BindingKind::eLocal:
+                _expression = [value = std::move(value), slot](Interpreter& interpreter) -> Value
+                {
+                    Value result = value(interpreter);
+                    interpreter._stack[interpreter._frameBase + slot] = result;
+                    return result;
+                };
+                return;
+            case Expressions::BindingKind::eUpvalue:
+                _expression = [value = std::move(value), slot](Interpreter& interpreter) -> Value
+                {
+                    Value result = value(interpreter);
+                    interpreter.upvalue(slot) = result;
+                    return result;
+                };
+                return;
+            case Expressions::BindingKind::eGlobal:
+                break;
+        }
+
+        _expression = [value = std::move(value), name = assignmentExpression.name](
+                          Interpreter& interpreter) -> Value
+        {
+            Value result = value(interpreter);
+            interpreter._globalEnvironment->assign(name, result);
+            return result;
+        };
+    }
+
+    void ClosureCompiler::visitBinaryExpression(Expressions::Binary& binaryExpression,
+                                                std::shared_ptr<Expression>& shared)
+    {
+        const Token& op = binaryExpression.op;
+        CompiledExpression left = compile(binaryExpression.left);
+        CompiledExpression right = compile(binaryExpression.right);
+
+        switch (op.type)
+        {
+            case TokenType::eMinus:
+                _expression = binary<std::minus<double>>(op, std::move(left), std::move(right));
+                return;
+            case TokenType::eSlash:
+                _expression = binary<std::divides<double>>(op, std::move(left), std::move(right));
+                return;
+            case TokenType::eStar:
+                _expression =
+                    binary<std::multiplies<double>>(op, std::move(left), std::move(right));
+                return;
+            case TokenType::ePlus:
+                _expression = binary<std::plus<double>>(op, std::move(left), std::move(right));
+                return;
+            case TokenType::eGreater:
+                _expression = binary<std::greater<double>>(op, std::move(left), std::move(right));
+                return;
+            case TokenType::eGreaterEqual:
+                _expression =
+                    binary<std::greater_equal<double>>(op, std::move(left), std::move(right));
+                return;
+            case TokenType::eLess:
+                _expression = binary<std::less<double>>(op, std::move(left), std::move(right));
+                return;
+            case TokenType::eLessEqual:
+                _expression =
+                    binary<std::less_equal<double>>(op, std::move(left), std::move(right));
+                return;
+            case TokenType::eEqualEqual:
+                _expression =
+                    binary<std::equal_to<double>>(op, std::move(left), std::move(right));
+                return;
+            case TokenType::eBangEqual:
+                _expression =
+                    binary<std::not_equal_to<double>>(op, std::move(left), std::move(right));
+                return;
+            default:
+                break;
+        }
+
+        // Left to raise the same error at runtime.
+        _expression = [op, left = std::move(left), right = std::move(right)](
+                          Interpreter& interpreter) -> Value
+        {
+            Value leftValue = left(interpreter);
+            Value rightValue = right(interpreter);
+            return applyOperator(op, leftValue, rightValue);
+        };
+    }
+
+    void ClosureCompiler::visitCallExpression(Expressions::Call& callExpression,
+                                              std::shared_ptr<Expression>& shared)
+    {
+        std::vector<CompiledExpression> arguments = compileAll(callExpression.arguments);
+        if (callExpression.property == nullptr)
+        {
+            _expression = [&callExpression,
+                           callee = compile(callExpression.callee),
+                           arguments = std::move(arguments)](Interpreter& interpreter) -> Value
+            { return callValue(interpreter, callExpression, arguments, callee(interpreter)); };
+            return;
+        }
+
+        // Methods are called without creating a bound method first.
+        Expressions::Get& property = *callExpression.property;
+        _expression = [&callExpression,
+                       &property,
+                       object = compile(property.object),
+                       arguments = std::move(arguments)](Interpreter& interpreter) -> Value
+        {
+            Value objectValue = object(interpreter);
+            auto* instance = std::get_if<std::shared_ptr<Types::Instance>>(&objectValue);
+            if (instance == nullptr) [[unlikely]]
+            {
+                throw RuntimeError(property.name, "Only instances have properties");
+            }
+
+            const Expressions::PropertyCacheEntry& entry =
+                interpreter.lookupProperty(property, **instance);
+            // Taken before the arguments run, since they can replace the cache entry.
+            std::shared_ptr<Types::Function> method = entry.method.lock();
+            if (method == nullptr)
+            {
+                return callValue(interpreter, callExpression, arguments, (*instance)->get(entry));
+            }
+
+            return withArguments(interpreter,
+                                 arguments,
+                                 [&](std::span<Value> values) -> Value
+                                 {
+                                     Interpreter::checkArity(
+                                         callExpression, method->arity(), values.size());
+                                     return method->call(interpreter, values, *instance);
+                                 });
+        };
+    }
+
+    void ClosureCompiler::visitGetExpression(Expressions::Get& getExpression,
+                                             std::shared_ptr<Expression>& shared)
+    {
+        _expression = [&getExpression, object = compile(getExpression.object)](
+                          Interpreter& interpreter) -> Value
+        {
+            Value objectValue = object(interpreter);
+            auto* instance = std::get_if<std::shared_ptr<Types::Instance>>(&objectValue);
+            if (instance == nullptr) [[unlikely]]
+            {
+                throw RuntimeError(getExpression.name, "Only instances have properties");
+            }
+
+            return (*instance)->get(interpreter.lookupProperty(getExpression, **instance));
+        };
+    }
+
+    void ClosureCompiler::visitGroupingExpression(Expressions::Grouping& groupingExpression,
+                                                  std::shared_ptr<Expression>& shared)
+    {
+        _expression = compile(groupingExpression.expression);
+    }
+
+    void ClosureCompiler::visitLiteralExpression(Expressions::Literal& literalExpression,
+                                                 std::shared_ptr<Expression>& shared)
+    {
+        _expression = [value = literalExpression.value](Interpreter&) -> Value { return value; };
+    }
+
+    void ClosureCompiler::visitLogicalExpression(Expressions::Logical& logicalExpression,
+                                                 std::shared_ptr<Expression>& shared)
+    {
+        CompiledExpression left = compile(logicalExpression.left);
+        CompiledExpression right = compile(logicalExpression.right);
+
+        if (logicalExpression.op.type == TokenType::eOr)
+        {
+            _expression = [left = std::move(left), right = std::move(right)](
+                              Interpreter& interpreter) -> Value
+            {
+                Value value = left(interpreter);
+                return value.isTruthy() ? value : right(interpreter);
+            };
+            return;
+        }
+
+        _expression = [left = std::move(left), right = std::move(right)](
+                          Interpreter& interpreter) -> Value
+        {
+            Value value = left(interpreter);
+            return !value.isTruthy() ? value : right(interpreter);
+        };
+    }
+
+    void ClosureCompiler::visitSetExpression(Expressions::Set& setExpression,
+                                             std::shared_ptr<Expression>& shared)
+    {
+        _expression = [&setExpression,
+                       object = compile(setExpression.object),
+                       value = compile(setExpression.value)](Interpreter& interpreter) -> Value
+        {
+            Value objectValue = object(interpreter);
+            auto* instance = std::get_if<std::shared_ptr<Types::Instance>>(&objectValue);
+            if (instance == nullptr) [[unlikely]]
+            {
+                throw RuntimeError(setExpression.name, "Only instances have fields");
+            }
+
+            Types::Instance& receiver = **instance;
+            Value result = value(interpreter);
+
+            const Expressions::PropertyCacheEntry* entry =
+                setExpression.cache.find(receiver.shape());
+            if (entry == nullptr)
+            {
+                entry = &setExpression.cache.add(receiver.resolveSet(setExpression.name));
+            }
+            receiver.set(*entry, result);
+            return result;
+        };
+    }
+
+    void ClosureCompiler::visitSuperExpression(Expressions::Super& superExpression,
+                                               std::shared_ptr<Expression>& shared)
+    {
+        _expression = [&superExpression,
+                       superclassValue = load(superExpression.keyword, superExpression.binding),
+                       objectValue = load(superExpression.keyword, superExpression.thisBinding)](
+                          Interpreter& interpreter) -> Value
+        {
+            Value superclassCallable = superclassValue(interpreter);
+            auto* callable = std::get_if<std::shared_ptr<Types::Callable>>(&superclassCallable);
+            if (callable == nullptr) [[unlikely]]
+            {
+                throw RuntimeError(superExpression.keyword, "Superclass must be a class");
+            }
+
+            auto superclass = std::dynamic_pointer_cast<Types::Class>(*callable);
+            if (superclass == nullptr) [[unlikely]]
+            {
+                throw RuntimeError(superExpression.keyword, "Superclass must be a class");
+            }
+
+            Value object = objectValue(interpreter);
+            auto* instance = std::get_if<std::shared_ptr<Types::Instance>>(&object);
+            if (instance == nullptr) [[unlikely]]
+            {
+                throw RuntimeError(superExpression.keyword, "Superclass must be a class");
+            }
+
+            const std::shared_ptr<Types::Function>& method = superclass->findMethod(
+                interpreter.selectorOf(superExpression.selector, superExpression.method.lexeme));
+            if (method == nullptr) [[unlikely]]
+            {
+                throw RuntimeError(superExpression.method, "Undefined property");
+            }
+
+            return std::static_pointer_cast<Types::Callable>(
+                std::make_shared<Types::Method>(*instance, method));
+        };
+    }
+
+    void ClosureCompiler::visitThisExpression(Expressions::This& thisExpression,
+                                              std::shared_ptr<Expression>& shared)
+    {
+        _expression = load(thisExpression.keyword, thisExpression.binding);
+    }
+
+    void ClosureCompiler::visitUnaryExpression(Expressions::Unary& unaryExpression,
+                                               std::shared_ptr<Expression>& shared)
+    {
+        CompiledExpression right = compile(unaryExpression.right);
+        switch (unaryExpression.op.type)
+        {
+            case TokenType::eMinus:
+                _expression = [op = unaryExpression.op, right = std::move(right)](
+                                  Interpreter& interpreter) -> Value
+                {
+                    std::optional<double> number = right(interpreter).asNumber();
+                    if (!number.has_value()) [[unlikely]]
+                    {
+                        throw RuntimeError(op, "Cannot negate a non-number");
+                    }
+                    return -*number;
+                };
+                return;
+            case TokenType::eBang:
+                _expression = [right = std::move(right)](Interpreter& interpreter) -> Value
+                { return !right(interpreter).isTruthy(); };
+                return;
+            default:
+                break;
+        }
+
+        _expression = [right = std::move(right)](Interpreter& interpreter) -> Value
+        {
+            right(interpreter);
+            return Types::Null {};
+        };
+    }
+
+    void ClosureCompiler::visitVariableExpression(Expressions::Variable& variableExpression,
+                                                  std::shared_ptr<Expression>& shared)
+    {
+        _expression = load(variableExpression.name, variableExpression.binding);
+    }
+}  // namespace sail
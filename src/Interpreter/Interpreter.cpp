@@ -21,26 +21,35 @@
 #include "Types/Types.h"
 #include "Types/Value.h"
 #include "fmt/format.h"
-#include "utils/Overload.h"
 
 namespace sail
 {
-    Interpreter::Interpreter()
-        : _globalEnvironment(std::make_unique<Environment>())
-        , _environment(_globalEnvironment)
+    Interpreter::Interpreter(Selectors& selectors, size_t maxCallDepth)
+        : _selectors(selectors)
+        , _globalEnvironment(std::make_unique<Environment>())
+        , _maxCallDepth(maxCallDepth)
     {
+        _stack.reserve(kInitialStackSize);
         defineNativeFunctions(*_globalEnvironment);
     }
 
     void Interpreter::interpret(std::vector<std::shared_ptr<Statement>>& statements)
     {
+        _nativeStack = NativeStack::current();
         auto each = [&](auto& statement) -> void { execute(statement); };
         std::ranges::for_each(statements, each);
     }
 
-    void Interpreter::execute(std::shared_ptr<Statement>& statement)
+    void Interpreter::interpret(const CompiledStatement& program)
+    {
+        _nativeStack = NativeStack::current();
+        program(*this);
+    }
+
+    auto Interpreter::execute(std::shared_ptr<Statement>& statement) -> Completion
     {
         statement->accept(*this, statement);
+        return _completion;
     }
 
     auto Interpreter::evaluate(std::shared_ptr<Expression>& expression) -> Value&
@@ -49,27 +58,209 @@ namespace sail
         return _returnValue;
     }
 
-    void Interpreter::resolve(const std::shared_ptr<Expression>& expression, size_t depth)
+    auto Interpreter::executeStatements(std::vector<std::shared_ptr<Statement>>& statements)
+        -> Completion
     {
-        _locals[expression] = depth;
+        for (auto& statement : statements)
+        {
+            if (execute(statement) == Completion::eReturn)
+            {
+                break;
+            }
+        }
+
+        return _completion;
     }
 
-    void Interpreter::executeBlock(std::vector<std::shared_ptr<Statement>>& statements,
-                                   std::shared_ptr<Environment> environment)
+    auto Interpreter::callFunction(Types::Function& function,
+                                   std::span<Value> arguments,
+                                   std::shared_ptr<Types::Instance> instance) -> Value
     {
-        std::shared_ptr<Environment> previousEnvironment = std::move(_environment);
-        _environment = std::move(environment);
+        if (_callDepth == _maxCallDepth || _nativeStack.exhausted()) [[unlikely]]
+        {
+            throw RuntimeError(function.declaration().name, "Stack overflow");
+        }
 
-        auto each = [&](auto& statement) -> void { execute(statement); };
-        std::ranges::for_each(statements, each);
+        const size_t base = _stack.size() - arguments.size();
+        const size_t previousFrameBase = std::exchange(_frameBase, base);
+        Types::Function* previousFunction = _function;
+
+        // Calls in tail position replace the running function in the same frame. The function
+        // they reached last is kept alive here, as its caller may have been the only owner.
+        Types::Function* running = &function;
+        std::shared_ptr<Types::Function> tailCalled;
+        bool discardResult = false;
+
+        // Runtime errors unwind through here as exceptions, so the caller's frame has to be
+        // restored on every exit path.
+        Value returnValue = Types::Null {};
+        _callDepth++;
+        try
+        {
+            while (true)
+            {
+                Statements::Function& declaration = running->declaration();
+                const size_t parameterCount = declaration.parameters.size();
+
+                _stack.resize(base + declaration.slotCount);
+                if (instance != nullptr)
+                {
+                    _stack[base + parameterCount] = std::move(instance);
+                    if (running->superclass() != nullptr)
+                    {
+                        _stack[base + parameterCount + 1] =
+                            std::static_pointer_cast<Types::Callable>(running->superclass());
+                    }
+                }
+                _function = running;
+
+                const CompiledStatement* compiledBody = running->compiledBody();
+                Completion completion = compiledBody != nullptr
+                                            ? (*compiledBody)(*this)
+                                            : executeStatements(declaration.body);
+                if (completion == Completion::eReturn && _tailCall.function != nullptr)
+                {
+                    TailCall tailCall = std::exchange(_tailCall, {});
+                    _completion = Completion::eNormal;
+
+                    // The arguments, on top of the stack, become the first slots of the frame.
+                    const size_t argumentCount = tailCall.function->arity();
+                    closeUpvalues(base);
+                    std::move(_stack.end() - static_cast<ptrdiff_t>(argumentCount),
+                              _stack.end(),
+                              _stack.begin() + static_cast<ptrdiff_t>(base));
+                    _stack.resize(base + argumentCount);
+
+                    discardResult = discardResult || tailCall.discardResult;
+                    instance = std::move(tailCall.instance);
+                    tailCalled = std::move(tailCall.function);
+                    running = tailCalled.get();
+                    continue;
+                }
+
+                if (completion == Completion::eReturn)
+                {
+                    returnValue = takeReturnValue();
+                }
+
+                if (running->isInitializer())
+                {
+                    returnValue = _stack[base + parameterCount];
+                }
+                break;
+            }
+        }
+        catch (...)
+        {
+            closeUpvalues(base);
+            _stack.resize(base);
+            _frameBase = previousFrameBase;
+            _function = previousFunction;
+            _callDepth--;
+            throw;
+        }
+
+        closeUpvalues(base);
+        _stack.resize(base);
+        _frameBase = previousFrameBase;
+        _function = previousFunction;
+        _callDepth--;
+        if (discardResult)
+        {
+            return Types::Null {};
+        }
+        return returnValue;
+    }
+
+    auto Interpreter::captureUpvalues(const Statements::Function& declaration)
+        -> std::vector<std::shared_ptr<Types::Upvalue>>
+    {
+        std::vector<std::shared_ptr<Types::Upvalue>> upvalues;
+        upvalues.reserve(declaration.captures.size());
+        for (const Statements::Capture& capture : declaration.captures)
+        {
+            if (capture.isLocal)
+            {
+                upvalues.push_back(captureUpvalue(_frameBase + capture.index));
+            }
+            else
+            {
+                upvalues.push_back(_function->upvalues()[capture.index]);
+            }
+        }
+
+        return upvalues;
+    }
+
+    auto Interpreter::captureUpvalue(size_t slot) -> std::shared_ptr<Types::Upvalue>
+    {
+        auto it = _openUpvalues.end();
+        while (it != _openUpvalues.begin() && (*std::prev(it))->slot >= slot)
+        {
+            --it;
+            if ((*it)->slot == slot)
+            {
+                return *it;
+            }
+        }
+
+        return *_openUpvalues.insert(it, std::make_shared<Types::Upvalue>(slot));
+    }
+
+    void Interpreter::closeUpvalues(size_t fromSlot)
+    {
+        while (!_openUpvalues.empty() && _openUpvalues.back()->slot >= fromSlot)
+        {
+            Types::Upvalue& upvalue = *_openUpvalues.back();
+            upvalue.closed = std::move(_stack[upvalue.slot]);
+            upvalue.open = false;
+            _openUpvalues.pop_back();
+        }
+    }
+
+    auto Interpreter::upvalue(size_t index) -> Value&
+    {
+        Types::Upvalue& upvalue = *_function->upvalues()[index];
+        if (upvalue.open)
+        {
+            return _stack[upvalue.slot];
+        }
+        return upvalue.closed;
+    }
 
-        _environment = std::move(previousEnvironment);
+    auto Interpreter::takeReturnValue() -> Value
+    {
+        _completion = Completion::eNormal;
+        return std::move(_returnValue);
     }
 
     void Interpreter::visitBlockStatement(Statements::Block& blockStatement,
                                           std::shared_ptr<Statement>& shared)
     {
-        executeBlock(blockStatement.statements, std::make_shared<Environment>(_environment));
+        // Inside a function the frame already covers every block, but top-level blocks use a frame
+        // of their own that grows as they are entered.
+        const size_t firstSlot = _frameBase + blockStatement.firstSlot;
+        if (_stack.size() < firstSlot + blockStatement.slotCount)
+        {
+            _stack.resize(firstSlot + blockStatement.slotCount);
+        }
+
+        if (!blockStatement.closesUpvalues) [[likely]]
+        {
+            executeStatements(blockStatement.statements);
+            return;
+        }
+
+        try
+        {
+            executeStatements(blockStatement.statements);
+        }
+        catch (...)
+        {
+            closeUpvalues(firstSlot);
+            throw;
+        }
+        closeUpvalues(firstSlot);
     }
 
     void Interpreter::visitClassStatement(Statements::Class& classStatement,
@@ -95,24 +286,29 @@ namespace sail
             }
         }
 
-        _environment->define(classStatement.name, Types::Null {});
+        declare(classStatement.name, classStatement.binding, Types::Null {});
 
-        ankerl::unordered_dense::map<std::string, std::shared_ptr<Types::Function>> methods;
+        std::vector<std::shared_ptr<Types::Function>> methods;
         for (std::shared_ptr<Statements::Function>& method : classStatement.methods)
         {
-            auto function = std::make_shared<Types::Function>(
-                method, _environment, method->possibleInitializer);
-            methods[function->name()] = function;
+            methods.push_back(std::make_shared<Types::Function>(
+                method, captureUpvalues(*method), method->possibleInitializer, superclass));
         }
 
         auto klass =
             std::make_shared<Types::Class>(classStatement.name.lexeme, superclass, methods);
-        _environment->assign(classStatement.name, klass);
+        declare(classStatement.name, classStatement.binding, klass);
     }
 
     void Interpreter::visitExpressionStatement(Statements::Expression& expressionStatement,
                                                std::shared_ptr<Statement>& shared)
     {
+        if (expressionStatement.tailCall != nullptr)
+        {
+            executeTailCall(*expressionStatement.tailCall, true);
+            return;
+        }
+
         evaluate(expressionStatement.expression);
     }
 
@@ -120,9 +316,9 @@ namespace sail
                                              std::shared_ptr<Statement>& shared)
     {
         auto functionStatementPointer = std::dynamic_pointer_cast<Statements::Function>(shared);
-        std::shared_ptr<Types::Function> function =
-            std::make_shared<Types::Function>(functionStatementPointer, _environment, false);
-        _environment->define(functionStatement.name, function);
+        std::shared_ptr<Types::Function> function = std::make_shared<Types::Function>(
+            functionStatementPointer, captureUpvalues(functionStatement), false);
+        declare(functionStatement.name, functionStatement.binding, function);
     }
 
     void Interpreter::visitIfStatement(Statements::If& ifStatement,
@@ -141,13 +337,20 @@ namespace sail
     void Interpreter::visitReturnStatement(Statements::Return& returnStatement,
                                            std::shared_ptr<Statement>& shared)
     {
+        if (returnStatement.tailCall != nullptr)
+        {
+            executeTailCall(*returnStatement.tailCall, false);
+            return;
+        }
+
         Value value = Types::Null {};
         if (returnStatement.value != nullptr)
         {
             value = evaluate(returnStatement.value);
         }
 
-        throw Return(value);
+        _returnValue = std::move(value);
+        _completion = Completion::eReturn;
     }
 
     void Interpreter::visitVariableStatement(Statements::Variable& variableStatement,
@@ -159,7 +362,7 @@ namespace sail
             value = evaluate(variableStatement.initializer);
         }
 
-        _environment->define(variableStatement.name, value);
+        declare(variableStatement.name, variableStatement.binding, value);
     }
 
     void Interpreter::visitWhileStatement(Statements::While& whileStatement,
@@ -167,7 +370,10 @@ namespace sail
     {
         while (evaluate(whileStatement.condition).isTruthy())
         {
-            execute(whileStatement.body);
+            if (execute(whileStatement.body) == Completion::eReturn)
+            {
+                return;
+            }
         }
     }
 
@@ -176,14 +382,18 @@ namespace sail
     {
         Value value = evaluate(assignmentExpression.value);
 
-        auto it = _locals.find(shared);
-        if (it != _locals.end()) [[likely]]
-        {
-            _environment->assignAt(it->second, assignmentExpression.name, value);
-        }
-        else
+        const Expressions::Binding& binding = assignmentExpression.binding;
+        switch (binding.kind)
         {
-            _globalEnvironment->assign(assignmentExpression.name, value);
+            case Expressions::BindingKind::eLocal:
+                _stack[_frameBase + binding.slot] = value;
+                break;
+            case Expressions::BindingKind::eUpvalue:
+                upvalue(binding.slot) = value;
+                break;
+            case Expressions::BindingKind::eGlobal:
+                _globalEnvironment->assign(assignmentExpression.name, value);
+                break;
         }
 
         _returnValue = std::move(value);
@@ -195,6 +405,21 @@ namespace sail
         Value left = evaluate(binaryExpression.left);
         Value right = evaluate(binaryExpression.right);
 
+        if (binaryExpression.operandTypes != Expressions::OperandTypes::eMixed) [[likely]]
+        {
+            const double* leftNumber = std::get_if<double>(&left);
+            const double* rightNumber = std::get_if<double>(&right);
+            if (leftNumber != nullptr && rightNumber != nullptr) [[likely]]
+            {
+                binaryExpression.operandTypes = Expressions::OperandTypes::eNumbers;
+                applyNumberOperator(binaryExpression.op, *leftNumber, *rightNumber);
+                return;
+            }
+
+            // The guard failed: the site now always takes the generic path below.
+            binaryExpression.operandTypes = Expressions::OperandTypes::eMixed;
+        }
+
         if (binaryExpression.op.type == TokenType::ePlus)
         {
             if (left.isString() && right.isString())
@@ -224,75 +449,249 @@ namespace sail
             throw RuntimeError(binaryExpression.op, "Cannot perform arithmetic on non-numbers");
         }
 
-        double leftValue = *leftNumber;
-        double rightValue = *rightNumber;
+        applyNumberOperator(binaryExpression.op, *leftNumber, *rightNumber);
+    }
 
-        switch (binaryExpression.op.type)
+    void Interpreter::applyNumberOperator(const Token& op, double left, double right)
+    {
+        switch (op.type)
         {
             case TokenType::eMinus:
-                _returnValue = leftValue - rightValue;
+                _returnValue = left - right;
                 return;
             case TokenType::eSlash:
-                _returnValue = leftValue / rightValue;
+                _returnValue = left / right;
                 return;
             case TokenType::eStar:
-                _returnValue = leftValue * rightValue;
+                _returnValue = left * right;
                 return;
             case TokenType::ePlus:
-                _returnValue = leftValue + rightValue;
+                _returnValue = left + right;
                 return;
             case TokenType::eGreater:
-                _returnValue = leftValue > rightValue;
+                _returnValue = left > right;
                 return;
             case TokenType::eGreaterEqual:
-                _returnValue = leftValue >= rightValue;
+                _returnValue = left >= right;
                 return;
             case TokenType::eLess:
-                _returnValue = leftValue < rightValue;
+                _returnValue = left < right;
                 return;
             case TokenType::eLessEqual:
-                _returnValue = leftValue <= rightValue;
+                _returnValue = left <= right;
+                return;
+            case TokenType::eEqualEqual:
+                _returnValue = left == right;
+                return;
+            case TokenType::eBangEqual:
+                _returnValue = left != right;
                 return;
             default:
                 [[unlikely]] break;
         }
 
-        throw RuntimeError(binaryExpression.op, "Unknown operator");
+        throw RuntimeError(op, "Unknown operator");
     }
 
     void Interpreter::visitCallExpression(Expressions::Call& callExpression,
                                           std::shared_ptr<Expression>& shared)
     {
+        if (callExpression.property != nullptr)
+        {
+            invoke(callExpression, *callExpression.property);
+            return;
+        }
+
         Value callee = evaluate(callExpression.callee);
+        callValue(callExpression, callee);
+    }
+
+    void Interpreter::invoke(Expressions::Call& callExpression, Expressions::Get& property)
+    {
+        Value object = evaluate(property.object);
+        auto* instance = std::get_if<std::shared_ptr<Types::Instance>>(&object);
+        if (instance == nullptr) [[unlikely]]
+        {
+            throw RuntimeError(property.name, "Only instances have properties");
+        }
+
+        const Expressions::PropertyCacheEntry& entry = lookupProperty(property, **instance);
+        // Taken before the arguments run, since they can replace the cache entry.
+        std::shared_ptr<Types::Function> method = entry.method.lock();
+        if (method == nullptr)
+        {
+            // A field holding a callable is called like any other value.
+            Value callee = (*instance)->get(entry);
+            callValue(callExpression, callee);
+            return;
+        }
+
+        withArguments(callExpression,
+                      [&](std::span<Value> arguments)
+                      {
+                          checkArity(callExpression, method->arity(), arguments.size());
+                          _returnValue = method->call(*this, arguments, *instance);
+                      });
+    }
+
+    void Interpreter::callValue(Expressions::Call& callExpression, const Value& callee)
+    {
+        withArguments(
+            callExpression,
+            [&](std::span<Value> arguments)
+            {
+                const auto* callable = std::get_if<std::shared_ptr<Types::Callable>>(&callee);
+                if (callable == nullptr || *callable == nullptr) [[unlikely]]
+                {
+                    throw RuntimeError(callExpression.paren,
+                                       "Can only call functions and classes");
+                }
+
+                checkArity(callExpression, (*callable)->arity(), arguments.size());
+                _returnValue = (*callable)->call(*this, arguments);
+            });
+    }
+
+    auto Interpreter::executeTailCall(Expressions::Call& callExpression, bool discardResult)
+        -> Completion
+    {
+        TailCall tailCall {.discardResult = discardResult};
+        Value callee;
+        if (callExpression.property != nullptr)
+        {
+            Expressions::Get& property = *callExpression.property;
+            Value object = evaluate(property.object);
+            auto* instance = std::get_if<std::shared_ptr<Types::Instance>>(&object);
+            if (instance == nullptr) [[unlikely]]
+            {
+                throw RuntimeError(property.name, "Only instances have properties");
+            }
+
+            const Expressions::PropertyCacheEntry& entry = lookupProperty(property, **instance);
+            tailCall.function = entry.method.lock();
+            if (tailCall.function != nullptr)
+            {
+                tailCall.instance = *instance;
+            }
+            else
+            {
+                callee = (*instance)->get(entry);
+            }
+        }
+        else
+        {
+            callee = evaluate(callExpression.callee);
+        }
+
+        if (tailCall.function == nullptr)
+        {
+            tailCallTarget(callee, tailCall);
+        }
+
+        if (tailCall.function == nullptr)
+        {
+            callValue(callExpression, callee);
+            _completion = discardResult ? Completion::eNormal : Completion::eReturn;
+            return _completion;
+        }
 
-        std::vector<Value> arguments;
+        // Left on the stack when an argument throws, for callFunction to drop with the frame.
+        const size_t base = _stack.size();
         for (auto& argument : callExpression.arguments)
         {
-            arguments.push_back(evaluate(argument));
+            _stack.push_back(std::move(evaluate(argument)));
         }
 
-        auto* callablePointer = std::get_if<std::shared_ptr<Types::Callable>>(&callee);
-        if (callablePointer == nullptr) [[unlikely]]
+        return scheduleTailCall(callExpression, std::move(tailCall), base);
+    }
+
+    void Interpreter::tailCallTarget(const Value& callee, TailCall& tailCall)
+    {
+        const auto* callable = std::get_if<std::shared_ptr<Types::Callable>>(&callee);
+        if (callable == nullptr)
+        {
+            return;
+        }
+
+        if (auto function = std::dynamic_pointer_cast<Types::Function>(*callable))
+        {
+            tailCall.function = std::move(function);
+        }
+        else if (auto* method = dynamic_cast<Types::Method*>(callable->get()))
         {
-            throw RuntimeError(callExpression.paren, "Can only call functions and classes");
+            tailCall.function = method->function();
+            tailCall.instance = method->instance();
         }
+    }
+
+    auto Interpreter::scheduleTailCall(const Expressions::Call& callExpression,
+                                       TailCall tailCall,
+                                       size_t argumentsBase) -> Completion
+    {
+        checkArity(callExpression, tailCall.function->arity(), _stack.size() - argumentsBase);
 
-        auto callable = *callablePointer;
-        if (callable == nullptr) [[unlikely]]
+        _tailCall = std::move(tailCall);
+        _returnValue = Types::Null {};
+        _completion = Completion::eReturn;
+        return _completion;
+    }
+
+    template<typename Call>
+    void Interpreter::withArguments(Expressions::Call& callExpression, Call&& call)
+    {
+        // Nested calls push above this one's arguments, so the span is only formed once all of
+        // them have been evaluated.
+        size_t base = _stack.size();
+        try
+        {
+            for (auto& argument : callExpression.arguments)
+            {
+                _stack.push_back(std::move(evaluate(argument)));
+            }
+            call(std::span<Value>(_stack).subspan(base));
+        }
+        catch (...)
         {
-            throw RuntimeError(callExpression.paren, "Can only call functions and classes");
+            _stack.resize(base);
+            throw;
         }
 
-        size_t arity = callable->arity();
-        if (arguments.size() != arity && arity != std::numeric_limits<size_t>::max()) [[unlikely]]
+        _stack.resize(base);
+    }
+
+    void Interpreter::checkArity(const Expressions::Call& callExpression,
+                                 size_t arity,
+                                 size_t argumentCount)
+    {
+        if (argumentCount != arity && arity != std::numeric_limits<size_t>::max()) [[unlikely]]
         {
             throw RuntimeError(
                 callExpression.paren,
-                fmt::format(
-                    "Expected {} arguments but got {}", callable->arity(), arguments.size()));
+                fmt::format("Expected {} arguments but got {}", arity, argumentCount));
         }
+    }
 
-        _returnValue = callable->call(*this, arguments);
+    auto Interpreter::lookupProperty(Expressions::Get& getExpression, Types::Instance& receiver)
+        -> const Expressions::PropertyCacheEntry&
+    {
+        const Expressions::PropertyCacheEntry* entry = getExpression.cache.find(receiver.shape());
+        if (entry != nullptr)
+        {
+            return *entry;
+        }
+
+        Selector selector = selectorOf(getExpression.selector, getExpression.name.lexeme);
+        return getExpression.cache.add(receiver.resolveGet(getExpression.name, selector));
+    }
+
+    auto Interpreter::selectorOf(Selector& selector, const std::string& name) const -> Selector
+    {
+        if (selector == Selectors::kNone)
+        {
+            selector = _selectors.find(name);
+        }
+
+        return selector;
     }
 
     void Interpreter::visitGetExpression(Expressions::Get& getExpression,
@@ -305,7 +704,7 @@ namespace sail
             throw RuntimeError(getExpression.name, "Only instances have properties");
         }
 
-        _returnValue = (*instance)->get(getExpression.name);
+        _returnValue = (*instance)->get(lookupProperty(getExpression, **instance));
     }
 
     void Interpreter::visitGroupingExpression(Expressions::Grouping& groupingExpression,
@@ -317,18 +716,7 @@ namespace sail
     void Interpreter::visitLiteralExpression(Expressions::Literal& literalExpression,
                                              std::shared_ptr<Expression>& shared)
     {
-        Value value {};
-
-        std::visit(
-            Overload {
-                [&](const std::string& str) { value = str; },
-                [&](const double& num) { value = num; },
-                [&](const bool& val) { value = val; },
-                [&](const Types::Null&) { value = Types::Null {}; },
-            },
-            literalExpression.literal);
-
-        _returnValue = std::move(value);
+        _returnValue = literalExpression.value;
     }
 
     void Interpreter::visitLogicalExpression(Expressions::Logical& logicalExpression,
@@ -367,16 +755,22 @@ namespace sail
             throw RuntimeError(setExpression.name, "Only instances have fields");
         }
 
+        Types::Instance& receiver = **instance;
         Value value = evaluate(setExpression.value);
-        (*instance)->set(setExpression.name, value);
+
+        const Expressions::PropertyCacheEntry* entry = setExpression.cache.find(receiver.shape());
+        if (entry == nullptr)
+        {
+            entry = &setExpression.cache.add(receiver.resolveSet(setExpression.name));
+        }
+        receiver.set(*entry, value);
         _returnValue = std::move(value);
     }
 
     void Interpreter::visitSuperExpression(Expressions::Super& superExpression,
                                            std::shared_ptr<Expression>& shared)
     {
-        size_t distance = _locals[shared];
-        Value superclassValue = _environment->getAt(distance, "super");
+        Value superclassValue = lookupVariable(superExpression.keyword, superExpression.binding);
         auto* superclassCallable = std::get_if<std::shared_ptr<Types::Callable>>(&superclassValue);
         if (superclassCallable == nullptr) [[unlikely]]
         {
@@ -389,27 +783,28 @@ namespace sail
             throw RuntimeError(superExpression.keyword, "Superclass must be a class");
         }
 
-        Value objectValue = _environment->getAt(distance, "this");
+        Value objectValue = lookupVariable(superExpression.keyword, superExpression.thisBinding);
         auto* objectInstance = std::get_if<std::shared_ptr<Types::Instance>>(&objectValue);
         if (objectInstance == nullptr) [[unlikely]]
         {
             throw RuntimeError(superExpression.keyword, "Superclass must be a class");
         }
 
-        std::shared_ptr<Types::Callable> method =
-            superclass->findMemberFunction(superExpression.method.lexeme);
+        const std::shared_ptr<Types::Function>& method = superclass->findMethod(
+            selectorOf(superExpression.selector, superExpression.method.lexeme));
         if (method == nullptr) [[unlikely]]
         {
             throw RuntimeError(superExpression.method, "Undefined property");
         }
 
-        _returnValue = method;
+        _returnValue = std::static_pointer_cast<Types::Callable>(
+            std::make_shared<Types::Method>(*objectInstance, method));
     }
 
     void Interpreter::visitThisExpression(Expressions::This& thisExpression,
                                           std::shared_ptr<Expression>& shared)
     {
-        _returnValue = lookupVariable(thisExpression.keyword, shared);
+        _returnValue = lookupVariable(thisExpression.keyword, thisExpression.binding);
     }
 
     void Interpreter::visitUnaryExpression(Expressions::Unary& unaryExpression,
@@ -443,17 +838,34 @@ namespace sail
     void Interpreter::visitVariableExpression(Expressions::Variable& variableExpression,
                                               std::shared_ptr<Expression>& shared)
     {
-        _returnValue = lookupVariable(variableExpression.name, shared);
+        _returnValue = lookupVariable(variableExpression.name, variableExpression.binding);
     }
 
-    auto Interpreter::lookupVariable(const Token& name,
-                                     const std::shared_ptr<Expression>& expression) -> Value
+    auto Interpreter::lookupVariable(const Token& name, const Expressions::Binding& binding)
+        -> Value
     {
-        auto it = _locals.find(expression);
-        if (it != _locals.end()) [[likely]]
+        switch (binding.kind)
         {
-            return _environment->getAt(it->second, name.lexeme);
+            case Expressions::BindingKind::eLocal:
+                return _stack[_frameBase + binding.slot];
+            case Expressions::BindingKind::eUpvalue:
+                return upvalue(binding.slot);
+            case Expressions::BindingKind::eGlobal:
+                break;
         }
         return _globalEnvironment->get(name);
     }
+
+    void Interpreter::declare(const Token& name,
+                              const Expressions::Binding& binding,
+                              const Value& value)
+    {
+        if (binding.kind == Expressions::BindingKind::eLocal)
+        {
+            _stack[_frameBase + binding.slot] = value;
+            return;
+        }
+
+        _globalEnvironment->define(name, value);
+    }
 }  // namespace sail
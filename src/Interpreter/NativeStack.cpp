@@ -0,0 +1,44 @@
+#include "Interpreter/NativeStack.h"
+
+#if defined(_WIN32)
+#    include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#    include <pthread.h>
+#endif
+
+namespace sail
+{
+    auto NativeStack::current() -> NativeStack
+    {
+        uintptr_t low = 0;
+        size_t size = 0;
+#if defined(_WIN32)
+        ULONG_PTR lowLimit = 0;
+        ULONG_PTR highLimit = 0;
+        GetCurrentThreadStackLimits(&lowLimit, &highLimit);
+        low = lowLimit;
+        size = highLimit - lowLimit;
+#elif defined(__APPLE__)
+        pthread_t thread = pthread_self();
+        size = pthread_get_stacksize_np(thread);
+        low = reinterpret_cast<uintptr_t>(pthread_get_stackaddr_np(thread)) - size;
+#elif defined(__linux__)
+        pthread_attr_t attributes;
+        if (pthread_getattr_np(pthread_self(), &attributes) == 0)
+        {
+            void* address = nullptr;
+            if (pthread_attr_getstack(&attributes, &address, &size) == 0)
+            {
+                low = reinterpret_cast<uintptr_t>(address);
+            }
+            pthread_attr_destroy(&attributes);
+        }
+#endif
+
+        if (low == 0 || size <= kHeadroom)
+        {
+            return {};
+        }
+        return NativeStack(low + kHeadroom);
+    }
+}  // namespace sail
@@ -0,0 +1,259 @@
+#include "Jit/Assembler.h"
+
+namespace sail
+{
+    namespace
+    {
+        auto encoding(Register reg) -> uint8_t
+        {
+            return static_cast<uint8_t>(reg);
+        }
+
+        auto encoding(XmmRegister reg) -> uint8_t
+        {
+            return static_cast<uint8_t>(reg);
+        }
+
+        // A ModRM byte addressing a register directly.
+        auto direct(uint8_t reg, uint8_t rm) -> uint8_t
+        {
+            return static_cast<uint8_t>(0xc0U | ((reg & 7U) << 3U) | (rm & 7U));
+        }
+    }  // namespace
+
+    void Assembler::push(Register reg)
+    {
+        rex(false, 0, encoding(reg));
+        emit(0x50 + (encoding(reg) & 7U));
+    }
+
+    void Assembler::pop(Register reg)
+    {
+        rex(false, 0, encoding(reg));
+        emit(0x58 + (encoding(reg) & 7U));
+    }
+
+    void Assembler::mov(Register destination, Register source)
+    {
+        registers(0x89, destination, source);
+    }
+
+    void Assembler::mov(Register destination, uint64_t immediate)
+    {
+        rex(true, 0, encoding(destination));
+        emit(0xb8 + (encoding(destination) & 7U));
+        emit64(immediate);
+    }
+
+    void Assembler::mov32(Register destination, uint32_t immediate)
+    {
+        rex(false, 0, encoding(destination));
+        emit(0xb8 + (encoding(destination) & 7U));
+        emit32(immediate);
+    }
+
+    void Assembler::load(Register destination, Register base, int32_t displacement)
+    {
+        memory(0x8b, destination, base, displacement);
+    }
+
+    void Assembler::store(Register base, int32_t displacement, Register source)
+    {
+        memory(0x89, source, base, displacement);
+    }
+
+    void Assembler::add(Register destination, int32_t immediate)
+    {
+        rex(true, 0, encoding(destination));
+        emit(0x81);
+        emit(direct(0, encoding(destination)));
+        emit32(static_cast<uint32_t>(immediate));
+    }
+
+    void Assembler::sub(Register destination, int32_t immediate)
+    {
+        rex(true, 0, encoding(destination));
+        emit(0x81);
+        emit(direct(5, encoding(destination)));
+        emit32(static_cast<uint32_t>(immediate));
+    }
+
+    void Assembler::bitwiseAnd(Register destination, Register source)
+    {
+        registers(0x21, destination, source);
+    }
+
+    void Assembler::bitwiseOr(Register destination, Register source)
+    {
+        registers(0x09, destination, source);
+    }
+
+    void Assembler::bitwiseXor(Register destination, Register source)
+    {
+        registers(0x31, destination, source);
+    }
+
+    void Assembler::cmp(Register left, Register right)
+    {
+        registers(0x39, left, right);
+    }
+
+    void Assembler::test(Register left, Register right)
+    {
+        registers(0x85, left, right);
+    }
+
+    void Assembler::testByte(Register reg)
+    {
+        // Without a REX prefix only the low bytes of rax to rbx can be encoded.
+        emit(0x84);
+        emit(direct(encoding(reg), encoding(reg)));
+    }
+
+    void Assembler::set(Condition condition, Register destination)
+    {
+        // setcc on the low byte, then movzx to clear the rest of the register.
+        emit(0x0f);
+        emit(0x90 | static_cast<uint8_t>(condition));
+        emit(direct(0, encoding(destination)));
+        emit(0x0f);
+        emit(0xb6);
+        emit(direct(encoding(destination), encoding(destination)));
+    }
+
+    void Assembler::movq(XmmRegister destination, Register source)
+    {
+        emit(0x66);
+        rex(true, encoding(destination), encoding(source));
+        emit(0x0f);
+        emit(0x6e);
+        emit(direct(encoding(destination), encoding(source)));
+    }
+
+    void Assembler::movq(Register destination, XmmRegister source)
+    {
+        emit(0x66);
+        rex(true, encoding(source), encoding(destination));
+        emit(0x0f);
+        emit(0x7e);
+        emit(direct(encoding(source), encoding(destination)));
+    }
+
+    void Assembler::arithmetic(DoubleOperation operation,
+                               XmmRegister destination,
+                               XmmRegister source)
+    {
+        emit(0xf2);
+        emit(0x0f);
+        emit(static_cast<uint8_t>(operation));
+        emit(direct(encoding(destination), encoding(source)));
+    }
+
+    void Assembler::ucomisd(XmmRegister left, XmmRegister right)
+    {
+        emit(0x66);
+        emit(0x0f);
+        emit(0x2e);
+        emit(direct(encoding(left), encoding(right)));
+    }
+
+    auto Assembler::jump() -> size_t
+    {
+        emit(0xe9);
+        size_t position = _code.size();
+        emit32(0);
+        return position;
+    }
+
+    auto Assembler::jump(Condition condition) -> size_t
+    {
+        emit(0x0f);
+        emit(0x80 | static_cast<uint8_t>(condition));
+        size_t position = _code.size();
+        emit32(0);
+        return position;
+    }
+
+    void Assembler::jumpTo(size_t target)
+    {
+        patch(jump(), target);
+    }
+
+    void Assembler::jumpTo(Condition condition, size_t target)
+    {
+        patch(jump(condition), target);
+    }
+
+    void Assembler::patch(size_t position, size_t target)
+    {
+        auto offset = static_cast<uint32_t>(static_cast<int64_t>(target)
+                                            - static_cast<int64_t>(position + 4));
+        for (size_t i = 0; i < 4; i++)
+        {
+            _code[position + i] = static_cast<uint8_t>(offset >> (8 * i));
+        }
+    }
+
+    void Assembler::call(Register target)
+    {
+        rex(false, 0, encoding(target));
+        emit(0xff);
+        emit(direct(2, encoding(target)));
+    }
+
+    void Assembler::ret()
+    {
+        emit(0xc3);
+    }
+
+    void Assembler::emit(uint8_t byte)
+    {
+        _code.push_back(byte);
+    }
+
+    void Assembler::emit32(uint32_t value)
+    {
+        for (size_t i = 0; i < 4; i++)
+        {
+            emit(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void Assembler::emit64(uint64_t value)
+    {
+        for (size_t i = 0; i < 8; i++)
+        {
+            emit(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void Assembler::rex(bool wide, uint8_t reg, uint8_t base)
+    {
+        auto prefix = static_cast<uint8_t>(0x40U | (wide ? 0x08U : 0U) | ((reg >> 3U) << 2U)
+                                           | (base >> 3U));
+        if (prefix != 0x40)
+        {
+            emit(prefix);
+        }
+    }
+
+    void Assembler::registers(uint8_t opCode, Register destination, Register source)
+    {
+        rex(true, encoding(source), encoding(destination));
+        emit(opCode);
+        emit(direct(encoding(source), encoding(destination)));
+    }
+
+    void Assembler::memory(uint8_t opCode, Register reg, Register base, int32_t displacement)
+    {
+        rex(true, encoding(reg), encoding(base));
+        emit(opCode);
+        // Mod 10: a 32-bit displacement. rsp and r12 as a base need a SIB byte.
+        emit(static_cast<uint8_t>(0x80U | ((encoding(reg) & 7U) << 3U) | (encoding(base) & 7U)));
+        if ((encoding(base) & 7U) == 4)
+        {
+            emit(0x24);
+        }
+        emit32(static_cast<uint32_t>(displacement));
+    }
+}  // namespace sail
@@ -0,0 +1,416 @@
+#include "Jit/JitCompiler.h"
+
+#if SAIL_JIT_SUPPORTED
+
+#    include <bit>
+#    include <cstring>
+
+#    include <sys/mman.h>
+#    include <unistd.h>
+
+#    include "Bytecode/OpCode.h"
+#    include "Jit/Assembler.h"
+
+namespace sail
+{
+    using Bytecode::OpCode;
+
+    namespace
+    {
+        // Registers holding the compiled function's state. All of them are callee-saved, so they
+        // survive calls into the slow path.
+        constexpr Register kMachine = Register::eRbx;
+        constexpr Register kSlots = Register::eR12;
+        constexpr Register kStackTop = Register::eR13;
+        // Kept loaded for the number checks.
+        constexpr Register kQuietNan = Register::eR14;
+
+        constexpr int32_t kValueSize = sizeof(Bytecode::Value);
+
+        auto bits(Bytecode::Value value) -> uint64_t
+        {
+            return std::bit_cast<uint64_t>(value);
+        }
+
+        auto isTruthy(uint64_t value) -> bool
+        {
+            return std::bit_cast<Bytecode::Value>(value).isTruthy();
+        }
+
+        auto readShort(const Bytecode::Chunk& chunk, size_t offset) -> uint16_t
+        {
+            return static_cast<uint16_t>((chunk.code[offset] << 8U) | chunk.code[offset + 1]);
+        }
+    }  // namespace
+
+    JitCompiler::JitCompiler(SlowPath slowPath)
+        : _slowPath(slowPath)
+    {
+    }
+
+    JitCompiler::~JitCompiler()
+    {
+        for (auto [memory, size] : _regions)
+        {
+            munmap(memory, size);
+        }
+    }
+
+    auto JitCompiler::compile(Objects::Function& function) -> bool
+    {
+        const Bytecode::Chunk& chunk = function.chunk;
+        const size_t length = chunk.code.size();
+        // Upvalues pointing into the frame have to be closed when it returns.
+        bool captures = false;
+        std::vector<size_t> loopStarts;
+        for (size_t offset = 0; offset < length; offset += chunk.instructionLength(offset))
+        {
+            const auto opCode = static_cast<OpCode>(chunk.code[offset]);
+            captures = captures || opCode == OpCode::eClosure;
+            if (opCode == OpCode::eLoop)
+            {
+                loopStarts.push_back(offset + 3 - readShort(chunk, offset + 1));
+            }
+        }
+
+        Assembler assembler;
+        // Native offset of each instruction, and the jumps waiting for them.
+        std::vector<size_t> starts(length + 1);
+        std::vector<std::pair<size_t, size_t>> branches;
+        std::vector<size_t> returns;
+        std::vector<size_t> failures;
+
+        auto prologue = [&]()
+        {
+            // Five pushes leave the stack 16-byte aligned for the calls below.
+            assembler.push(Register::eRbx);
+            assembler.push(Register::eRbp);
+            assembler.push(Register::eR12);
+            assembler.push(Register::eR13);
+            assembler.push(Register::eR14);
+            assembler.mov(kMachine, Register::eRdi);
+            assembler.mov(kSlots, Register::eRsi);
+            assembler.mov(kStackTop, Register::eRdx);
+            assembler.mov(kQuietNan, Bytecode::Value::kQuietNan);
+        };
+        prologue();
+
+        auto pushValue = [&](Register source)
+        {
+            assembler.store(kStackTop, 0, source);
+            assembler.add(kStackTop, kValueSize);
+        };
+        auto local = [&](size_t offset) -> int32_t
+        { return static_cast<int32_t>(chunk.code[offset + 1]) * kValueSize; };
+        auto constant = [&](size_t offset) -> uint64_t
+        { return bits(chunk.constants[readShort(chunk, offset)]); };
+        auto branch = [&](size_t target) { branches.emplace_back(assembler.jump(), target); };
+        auto branchIf = [&](Condition condition, size_t target)
+        { branches.emplace_back(assembler.jump(condition), target); };
+        // Jumps to one of the slow path's positions unless the register holds a number.
+        auto guardNumber = [&](Register reg, std::vector<size_t>& slow)
+        {
+            assembler.mov(Register::eRcx, reg);
+            assembler.bitwiseAnd(Register::eRcx, kQuietNan);
+            assembler.cmp(Register::eRcx, kQuietNan);
+            slow.push_back(assembler.jump(Condition::eEqual));
+        };
+        auto bindAll = [&](const std::vector<size_t>& positions)
+        {
+            for (size_t position : positions)
+            {
+                assembler.patch(position, assembler.size());
+            }
+        };
+        auto slowPath = [&](size_t offset, OpCode opCode)
+        {
+            assembler.mov(Register::eRdi, kMachine);
+            assembler.mov(Register::eRsi, kStackTop);
+            assembler.mov(Register::eRdx, reinterpret_cast<uint64_t>(&chunk.code[offset]));
+            assembler.mov32(Register::eRcx, static_cast<uint32_t>(opCode));
+            assembler.mov(Register::eRax, reinterpret_cast<uint64_t>(_slowPath));
+            assembler.call(Register::eRax);
+            assembler.test(Register::eRax, Register::eRax);
+            failures.push_back(assembler.jump(Condition::eEqual));
+            assembler.mov(kStackTop, Register::eRax);
+        };
+        // Loads both operands of a binary instruction, or goes to the slow path.
+        auto loadNumbers = [&](std::vector<size_t>& slow)
+        {
+            assembler.load(Register::eRax, kStackTop, -2 * kValueSize);
+            assembler.load(Register::eRdx, kStackTop, -kValueSize);
+            guardNumber(Register::eRax, slow);
+            guardNumber(Register::eRdx, slow);
+            assembler.movq(XmmRegister::eXmm0, Register::eRax);
+            assembler.movq(XmmRegister::eXmm1, Register::eRdx);
+        };
+        // Compares the operands loaded by loadNumbers, so that eAbove or eAboveEqual means the
+        // comparison holds. Both are false when either operand is NaN.
+        auto compare = [&](OpCode opCode) -> Condition
+        {
+            bool less = opCode == OpCode::eLess || opCode == OpCode::eLessEqual
+                        || opCode == OpCode::eLessJumpIfFalse;
+            if (less)
+            {
+                assembler.ucomisd(XmmRegister::eXmm1, XmmRegister::eXmm0);
+            }
+            else
+            {
+                assembler.ucomisd(XmmRegister::eXmm0, XmmRegister::eXmm1);
+            }
+            bool orEqual = opCode == OpCode::eLessEqual || opCode == OpCode::eGreaterEqual;
+            return orEqual ? Condition::eAboveEqual : Condition::eAbove;
+        };
+
+        for (size_t offset = 0; offset < length; offset += chunk.instructionLength(offset))
+        {
+            starts[offset] = assembler.size();
+            const size_t next = offset + chunk.instructionLength(offset);
+            const auto opCode = static_cast<OpCode>(chunk.code[offset]);
+            std::vector<size_t> slow;
+
+            switch (opCode)
+            {
+                case OpCode::eConstant:
+                    assembler.mov(Register::eRax, constant(offset + 1));
+                    pushValue(Register::eRax);
+                    break;
+                case OpCode::eNull:
+                    assembler.mov(Register::eRax, Bytecode::Value::kNull);
+                    pushValue(Register::eRax);
+                    break;
+                case OpCode::eTrue:
+                    assembler.mov(Register::eRax, Bytecode::Value::kTrue);
+                    pushValue(Register::eRax);
+                    break;
+                case OpCode::eFalse:
+                    assembler.mov(Register::eRax, Bytecode::Value::kFalse);
+                    pushValue(Register::eRax);
+                    break;
+                case OpCode::ePop:
+                    assembler.sub(kStackTop, kValueSize);
+                    break;
+
+                case OpCode::eGetLocal:
+                    assembler.load(Register::eRax, kSlots, local(offset));
+                    pushValue(Register::eRax);
+                    break;
+                case OpCode::eSetLocal:
+                    assembler.load(Register::eRax, kStackTop, -kValueSize);
+                    assembler.store(kSlots, local(offset), Register::eRax);
+                    break;
+                case OpCode::eGetLocalConstant:
+                    assembler.load(Register::eRax, kSlots, local(offset));
+                    pushValue(Register::eRax);
+                    assembler.mov(Register::eRax, constant(offset + 2));
+                    pushValue(Register::eRax);
+                    break;
+                case OpCode::eSetLocalPop:
+                    assembler.load(Register::eRax, kStackTop, -kValueSize);
+                    assembler.sub(kStackTop, kValueSize);
+                    assembler.store(kSlots, local(offset), Register::eRax);
+                    break;
+                case OpCode::eIncrementLocal:
+                {
+                    // The peephole pass only fuses increments by a number constant.
+                    assembler.load(Register::eRax, kSlots, local(offset));
+                    guardNumber(Register::eRax, slow);
+                    assembler.movq(XmmRegister::eXmm0, Register::eRax);
+                    assembler.mov(Register::eRdx, constant(offset + 2));
+                    assembler.movq(XmmRegister::eXmm1, Register::eRdx);
+                    assembler.arithmetic(
+                        DoubleOperation::eAdd, XmmRegister::eXmm0, XmmRegister::eXmm1);
+                    assembler.movq(Register::eRax, XmmRegister::eXmm0);
+                    assembler.store(kSlots, local(offset), Register::eRax);
+                    size_t done = assembler.jump();
+                    bindAll(slow);
+                    slowPath(offset, opCode);
+                    assembler.patch(done, assembler.size());
+                    break;
+                }
+
+                case OpCode::eAdd:
+                case OpCode::eSubtract:
+                case OpCode::eMultiply:
+                case OpCode::eDivide:
+                {
+                    // In the order of the OpCode enum.
+                    static constexpr DoubleOperation kOperations[] = {DoubleOperation::eAdd,
+                                                                      DoubleOperation::eSubtract,
+                                                                      DoubleOperation::eMultiply,
+                                                                      DoubleOperation::eDivide};
+                    const size_t index =
+                        static_cast<size_t>(opCode) - static_cast<size_t>(OpCode::eAdd);
+                    loadNumbers(slow);
+                    assembler.arithmetic(
+                        kOperations[index], XmmRegister::eXmm0, XmmRegister::eXmm1);
+                    assembler.movq(Register::eRax, XmmRegister::eXmm0);
+                    assembler.store(kStackTop, -2 * kValueSize, Register::eRax);
+                    assembler.sub(kStackTop, kValueSize);
+                    size_t done = assembler.jump();
+                    bindAll(slow);
+                    slowPath(offset, opCode);
+                    assembler.patch(done, assembler.size());
+                    break;
+                }
+                case OpCode::eGreater:
+                case OpCode::eGreaterEqual:
+                case OpCode::eLess:
+                case OpCode::eLessEqual:
+                {
+                    // false and true differ only in the lowest bit.
+                    loadNumbers(slow);
+                    assembler.set(compare(opCode), Register::eRax);
+                    assembler.mov(Register::eRcx, Bytecode::Value::kFalse);
+                    assembler.bitwiseOr(Register::eRax, Register::eRcx);
+                    assembler.store(kStackTop, -2 * kValueSize, Register::eRax);
+                    assembler.sub(kStackTop, kValueSize);
+                    size_t done = assembler.jump();
+                    bindAll(slow);
+                    slowPath(offset, opCode);
+                    assembler.patch(done, assembler.size());
+                    break;
+                }
+                case OpCode::eNegate:
+                {
+                    assembler.load(Register::eRax, kStackTop, -kValueSize);
+                    guardNumber(Register::eRax, slow);
+                    assembler.mov(Register::eRcx, Bytecode::Value::kSignBit);
+                    assembler.bitwiseXor(Register::eRax, Register::eRcx);
+                    assembler.store(kStackTop, -kValueSize, Register::eRax);
+                    size_t done = assembler.jump();
+                    bindAll(slow);
+                    slowPath(offset, opCode);
+                    assembler.patch(done, assembler.size());
+                    break;
+                }
+
+                case OpCode::eJump:
+                    branch(next + readShort(chunk, offset + 1));
+                    break;
+                case OpCode::eLoop:
+                    branch(next - readShort(chunk, offset + 1));
+                    break;
+                case OpCode::eJumpIfFalse:
+                {
+                    const size_t target = next + readShort(chunk, offset + 1);
+                    assembler.load(Register::eRax, kStackTop, -kValueSize);
+                    assembler.mov(Register::eRcx, Bytecode::Value::kTrue);
+                    assembler.cmp(Register::eRax, Register::eRcx);
+                    size_t truthy = assembler.jump(Condition::eEqual);
+                    assembler.mov(Register::eRcx, Bytecode::Value::kFalse);
+                    assembler.cmp(Register::eRax, Register::eRcx);
+                    branchIf(Condition::eEqual, target);
+                    assembler.mov(Register::eRdi, Register::eRax);
+                    assembler.mov(Register::eRax, reinterpret_cast<uint64_t>(&isTruthy));
+                    assembler.call(Register::eRax);
+                    assembler.testByte(Register::eRax);
+                    branchIf(Condition::eEqual, target);
+                    assembler.patch(truthy, assembler.size());
+                    break;
+                }
+                case OpCode::eLessJumpIfFalse:
+                case OpCode::eGreaterJumpIfFalse:
+                {
+                    // Like the interpreter, a failed comparison leaves false for the target to pop.
+                    const size_t target = next + readShort(chunk, offset + 1);
+                    loadNumbers(slow);
+                    // Popped before comparing, as sub would overwrite the flags.
+                    assembler.sub(kStackTop, 2 * kValueSize);
+                    Condition holds = compare(opCode);
+                    size_t done = assembler.jump(holds);
+                    assembler.mov(Register::eRax, Bytecode::Value::kFalse);
+                    pushValue(Register::eRax);
+                    branch(target);
+
+                    bindAll(slow);
+                    slowPath(offset,
+                             opCode == OpCode::eLessJumpIfFalse ? OpCode::eLess : OpCode::eGreater);
+                    assembler.load(Register::eRax, kStackTop, -kValueSize);
+                    assembler.mov(Register::eRcx, Bytecode::Value::kTrue);
+                    assembler.cmp(Register::eRax, Register::eRcx);
+                    branchIf(Condition::eNotEqual, target);
+                    assembler.sub(kStackTop, kValueSize);
+                    assembler.patch(done, assembler.size());
+                    break;
+                }
+
+                case OpCode::eReturn:
+                    if (captures)
+                    {
+                        slowPath(offset, opCode);
+                    }
+                    assembler.load(Register::eRcx, kStackTop, -kValueSize);
+                    assembler.store(kSlots, 0, Register::eRcx);
+                    assembler.mov(Register::eRax, kSlots);
+                    assembler.add(Register::eRax, kValueSize);
+                    returns.push_back(assembler.jump());
+                    break;
+                case OpCode::eTailCall:
+                    // The frame now belongs to the callee, so the compiled code always leaves it.
+                    slowPath(offset, opCode);
+                    returns.push_back(assembler.jump());
+                    break;
+
+                default:
+                    slowPath(offset, opCode);
+                    break;
+            }
+        }
+        starts[length] = assembler.size();
+
+        bindAll(failures);
+        assembler.mov(Register::eRax, uint64_t {0});
+        bindAll(returns);
+        assembler.pop(Register::eR14);
+        assembler.pop(Register::eR13);
+        assembler.pop(Register::eR12);
+        assembler.pop(Register::eRbp);
+        assembler.pop(Register::eRbx);
+        assembler.ret();
+
+        for (auto [position, target] : branches)
+        {
+            assembler.patch(position, starts[target]);
+        }
+
+        // Loop entries set up the registers the same way, then jump into the body.
+        std::vector<size_t> loopEntries;
+        for (size_t start : loopStarts)
+        {
+            loopEntries.push_back(assembler.size());
+            prologue();
+            assembler.jumpTo(starts[start]);
+        }
+
+        // Written while the pages are writable, then switched to executable only.
+        const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t size = (assembler.size() + pageSize - 1) / pageSize * pageSize;
+        void* memory =
+            mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            return false;
+        }
+
+        std::memcpy(memory, assembler.code().data(), assembler.size());
+        if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0)
+        {
+            munmap(memory, size);
+            return false;
+        }
+
+        _regions.emplace_back(memory, size);
+        function.compiled = reinterpret_cast<Objects::CompiledCode>(memory);
+        for (size_t i = 0; i < loopStarts.size(); i++)
+        {
+            function.loopEntries.emplace_back(
+                loopStarts[i],
+                reinterpret_cast<Objects::CompiledCode>(static_cast<uint8_t*>(memory)
+                                                        + loopEntries[i]));
+        }
+        return true;
+    }
+}  // namespace sail
+
+#endif
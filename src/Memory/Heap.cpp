@@ -0,0 +1,592 @@
+#include <algorithm>
+#include <limits>
+
+#include "Memory/Heap.h"
+
+#include "Objects/Objects.h"
+
+namespace sail
+{
+    namespace
+    {
+        constexpr size_t kAlignment = alignof(std::max_align_t);
+        constexpr size_t kNurserySize = Heap::kNurseryBlocks * Heap::kBlockSize;
+        // While marking is in progress the nursery may grow up to this size before marking is
+        // forced to finish, so that a mutator outpacing the collector cannot grow it without bound.
+        constexpr size_t kMarkingNurseryLimit = 4 * kNurserySize;
+        // Objects traced or swept between two checks of the slice deadline.
+        constexpr size_t kWorkChunk = 64;
+
+        constexpr auto alignUp(size_t size) -> size_t
+        {
+            return (size + kAlignment - 1) & ~(kAlignment - 1);
+        }
+    }  // namespace
+
+    template<typename Work>
+    void Heap::pause(Work&& work)
+    {
+        auto start = std::chrono::steady_clock::now();
+        work();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        _statistics.pauses++;
+        _statistics.totalPause += elapsed;
+        _statistics.maxPause = std::max(_statistics.maxPause, elapsed);
+    }
+
+    Heap::~Heap()
+    {
+        for (Object* list : {_objects, _youngObjects, _sweepList})
+        {
+            while (list != nullptr)
+            {
+                Object* next = list->next;
+                list->~Object();
+                list = next;
+            }
+        }
+
+        if (_activeBlock != nullptr)
+        {
+            _fullBlocks.push_back(_activeBlock);
+        }
+        for (std::vector<Block*>* blocks : {&_fullBlocks, &_freeBlocks})
+        {
+            for (Block* block : *blocks)
+            {
+                ::operator delete(block, std::align_val_t {kBlockSize});
+            }
+        }
+    }
+
+    void Heap::addRoots(HeapRoots* roots)
+    {
+        _roots.push_back(roots);
+    }
+
+    void Heap::removeRoots(HeapRoots* roots)
+    {
+        std::erase(_roots, roots);
+    }
+
+    auto Heap::intern(std::string_view chars) -> Objects::String*
+    {
+        auto it = _strings.find(chars);
+        if (it != _strings.end())
+        {
+            // Marking may not have reached the string yet, and it is about to become reachable.
+            if (_phase == Phase::eMarking)
+            {
+                markObject(it->second);
+            }
+            return it->second;
+        }
+
+        auto* string = allocate<Objects::String>(std::string(chars));
+        _strings.emplace(string->value, string);
+        return string;
+    }
+
+    void Heap::collect()
+    {
+        pause(
+            [this]
+            {
+                finishCycle();
+                fullCollection();
+            });
+    }
+
+    void Heap::collectNursery()
+    {
+        pause(
+            [this]
+            {
+                if (_phase == Phase::eMarking)
+                {
+                    finishMarking();
+                }
+                minorCollection();
+            });
+    }
+
+    void Heap::markValue(Bytecode::Value value)
+    {
+        if (value.isObject())
+        {
+            markObject(value.asObject());
+        }
+    }
+
+    void Heap::markObject(Object* object)
+    {
+        if (object == nullptr || object->marked || (_tracingNursery && object->old))
+        {
+            return;
+        }
+
+        object->marked = true;
+        _grayStack.push_back(object);
+    }
+
+    auto Heap::allocateYoung(size_t size) -> void*
+    {
+        size = alignUp(size);
+
+#ifdef SAIL_STRESS_GC
+        if (_phase != Phase::eIdle)
+        {
+            pause([this] { step(); });
+        }
+        else if ((_statistics.collections + _statistics.minorCollections) % 4 == 3)
+        {
+            pause([this] { _sliceBudget.count() > 0 ? startCycle() : fullCollection(); });
+        }
+        else
+        {
+            pause([this] { minorCollection(); });
+        }
+#else
+        if (_phase != Phase::eIdle && _bytesSinceSlice >= kSliceInterval)
+        {
+            _bytesSinceSlice = 0;
+            pause([this] { step(); });
+        }
+
+        if (_phase == Phase::eMarking)
+        {
+            if (_youngBytes >= kMarkingNurseryLimit)
+            {
+                pause([this] { finishMarking(); });
+            }
+        }
+        else if (_youngBytes >= kNurserySize)
+        {
+            pause([this] { minorCollection(); });
+        }
+#endif
+
+        if (static_cast<size_t>(_limit - _cursor) < size)
+        {
+            if (_activeBlock != nullptr)
+            {
+                _fullBlocks.push_back(_activeBlock);
+            }
+
+            _activeBlock = newBlock();
+            _cursor = reinterpret_cast<std::byte*>(_activeBlock) + alignUp(sizeof(Block));
+            _limit = reinterpret_cast<std::byte*>(_activeBlock) + kBlockSize;
+        }
+
+        void* memory = _cursor;
+        _cursor += size;
+        _youngBytes += size;
+        _bytesSinceSlice += size;
+        return memory;
+    }
+
+    auto Heap::newBlock() -> Block*
+    {
+        void* memory = nullptr;
+        if (!_freeBlocks.empty())
+        {
+            memory = _freeBlocks.back();
+            _freeBlocks.pop_back();
+        }
+        else
+        {
+            memory = ::operator new(kBlockSize, std::align_val_t {kBlockSize});
+        }
+
+        return new (memory) Block {};
+    }
+
+    void Heap::releaseEmptyBlocks()
+    {
+        std::erase_if(_fullBlocks,
+                      [this](Block* block)
+                      {
+                          if (block->liveObjects != 0)
+                          {
+                              return false;
+                          }
+
+                          if (_freeBlocks.size() < kNurseryBlocks)
+                          {
+                              _freeBlocks.push_back(block);
+                          }
+                          else
+                          {
+                              ::operator delete(block, std::align_val_t {kBlockSize});
+                          }
+                          return true;
+                      });
+
+        if (_activeBlock != nullptr && _activeBlock->liveObjects == 0)
+        {
+            _cursor = reinterpret_cast<std::byte*>(_activeBlock) + alignUp(sizeof(Block));
+        }
+    }
+
+    void Heap::track(Object* object, size_t size)
+    {
+        // Strings are immutable, so their payload can be accounted for once up front.
+        if (object->type == ObjectType::eString)
+        {
+            size += static_cast<Objects::String*>(object)->value.capacity();
+        }
+
+        object->size = size;
+        object->next = _youngObjects;
+        _youngObjects = object;
+        blockOf(object)->liveObjects++;
+
+        // Allocating gray keeps everything the constructor stored in the object from being missed.
+        if (_phase == Phase::eMarking)
+        {
+            object->marked = true;
+            _grayStack.push_back(object);
+        }
+
+        _statistics.bytesAllocated += size;
+        _statistics.peakBytesAllocated =
+            std::max(_statistics.peakBytesAllocated, _statistics.bytesAllocated);
+        _statistics.objectCount++;
+    }
+
+    void Heap::remember(Object* object)
+    {
+        object->remembered = true;
+        _rememberedSet.push_back(object);
+    }
+
+    void Heap::forgetRemembered()
+    {
+        for (Object* object : _rememberedSet)
+        {
+            object->remembered = false;
+        }
+        _rememberedSet.clear();
+    }
+
+    void Heap::markRootSets()
+    {
+        for (HeapRoots* roots : _roots)
+        {
+            roots->markRoots(*this);
+        }
+    }
+
+    void Heap::traceReferences()
+    {
+        while (!_grayStack.empty())
+        {
+            Object* object = _grayStack.back();
+            _grayStack.pop_back();
+            blacken(object);
+        }
+    }
+
+    void Heap::blacken(Object* object)
+    {
+        switch (object->type)
+        {
+            case ObjectType::eBoundMethod:
+            {
+                auto* bound = static_cast<Objects::BoundMethod*>(object);
+                markValue(bound->receiver);
+                markObject(bound->method);
+                break;
+            }
+            case ObjectType::eClass:
+            {
+                auto* klass = static_cast<Objects::Class*>(object);
+                markObject(klass->superclass);
+                for (auto& [name, method] : klass->methods)
+                {
+                    markObject(name);
+                    markObject(method);
+                }
+                break;
+            }
+            case ObjectType::eClosure:
+            {
+                auto* closure = static_cast<Objects::Closure*>(object);
+                markObject(closure->function);
+                for (Objects::Upvalue* upvalue : closure->upvalues)
+                {
+                    markObject(upvalue);
+                }
+                break;
+            }
+            case ObjectType::eFunction:
+            {
+                auto* function = static_cast<Objects::Function*>(object);
+                for (Bytecode::Value constant : function->chunk.constants)
+                {
+                    markValue(constant);
+                }
+                break;
+            }
+            case ObjectType::eInstance:
+            {
+                auto* instance = static_cast<Objects::Instance*>(object);
+                markObject(instance->klass);
+                for (auto& [name, value] : instance->fields)
+                {
+                    markObject(name);
+                    markValue(value);
+                }
+                break;
+            }
+            case ObjectType::eUpvalue:
+                markValue(static_cast<Objects::Upvalue*>(object)->closed);
+                break;
+            case ObjectType::eNative:
+            case ObjectType::eString:
+                break;
+        }
+    }
+
+    void Heap::removeUnmarkedStrings()
+    {
+        for (auto it = _strings.begin(); it != _strings.end();)
+        {
+            it = it->second->marked ? std::next(it) : _strings.erase(it);
+        }
+    }
+
+    void Heap::promoteNursery()
+    {
+        Object* object = _youngObjects;
+        while (object != nullptr)
+        {
+            Object* next = object->next;
+            if (object->marked)
+            {
+                object->marked = false;
+                object->old = true;
+                object->next = _objects;
+                _objects = object;
+
+                _oldBytes += object->size;
+                _statistics.bytesPromoted += object->size;
+            }
+            else
+            {
+                destroy(object);
+            }
+            object = next;
+        }
+
+        _youngObjects = nullptr;
+        _youngBytes = 0;
+    }
+
+    void Heap::sweepOldGeneration()
+    {
+        Object* previous = nullptr;
+        Object* object = _objects;
+        while (object != nullptr)
+        {
+            if (object->marked)
+            {
+                object->marked = false;
+                previous = object;
+                object = object->next;
+                continue;
+            }
+
+            Object* unreached = object;
+            object = object->next;
+            if (previous != nullptr)
+            {
+                previous->next = object;
+            }
+            else
+            {
+                _objects = object;
+            }
+
+            _oldBytes -= unreached->size;
+            destroy(unreached);
+        }
+    }
+
+    void Heap::fullCollection()
+    {
+        // Every object is traced, so old objects no longer need to be remembered.
+        forgetRemembered();
+
+        markRootSets();
+        traceReferences();
+        sweepOldGeneration();
+        promoteNursery();
+        releaseEmptyBlocks();
+
+        _nextCollection = std::max(_oldBytes * kGrowthFactor, kInitialThreshold);
+        _statistics.collections++;
+    }
+
+    void Heap::minorCollection()
+    {
+        // Old objects are treated as live without being traced. The only way to reach a young
+        // object through one is a reference recorded by the write barrier.
+        _tracingNursery = true;
+        markRootSets();
+        for (Object* object : _rememberedSet)
+        {
+            object->remembered = false;
+            blacken(object);
+        }
+        _rememberedSet.clear();
+        traceReferences();
+        _tracingNursery = false;
+
+        promoteNursery();
+        releaseEmptyBlocks();
+        _statistics.minorCollections++;
+
+        if (_phase == Phase::eIdle && _oldBytes > _nextCollection)
+        {
+            _sliceBudget.count() > 0 ? startCycle() : fullCollection();
+        }
+    }
+
+    void Heap::startCycle()
+    {
+        _phase = Phase::eMarking;
+        _bytesSinceSlice = 0;
+        markRootSets();
+    }
+
+    void Heap::step()
+    {
+        auto deadline = std::chrono::steady_clock::now() + _sliceBudget;
+        do
+        {
+            if (_phase == Phase::eMarking)
+            {
+                for (size_t i = 0; i < kWorkChunk && !_grayStack.empty(); i++)
+                {
+                    Object* object = _grayStack.back();
+                    _grayStack.pop_back();
+                    blacken(object);
+                }
+
+                if (_grayStack.empty())
+                {
+                    finishMarking();
+                    return;
+                }
+            }
+            else if (_phase != Phase::eSweeping || sweepSome(kWorkChunk))
+            {
+                return;
+            }
+        } while (std::chrono::steady_clock::now() < deadline);
+    }
+
+    void Heap::finishMarking()
+    {
+        // Remark: stores into roots are not barriered, so rescan them and trace whatever they
+        // reach that is still white.
+        markRootSets();
+        traceReferences();
+        // Sweeping is incremental, so dead strings have to leave the table before the mutator can
+        // look them up again.
+        removeUnmarkedStrings();
+
+        // Every young object is either promoted or freed below, so no old-to-young references
+        // remain. The old generation is detached first so that the objects promoted now are not
+        // swept by this cycle.
+        forgetRemembered();
+        _sweepList = _objects;
+        _objects = nullptr;
+        promoteNursery();
+        releaseEmptyBlocks();
+
+        _phase = Phase::eSweeping;
+    }
+
+    void Heap::finishCycle()
+    {
+        if (_phase == Phase::eMarking)
+        {
+            finishMarking();
+        }
+        if (_phase == Phase::eSweeping)
+        {
+            sweepSome(std::numeric_limits<size_t>::max());
+        }
+    }
+
+    auto Heap::sweepSome(size_t count) -> bool
+    {
+        for (; count > 0 && _sweepList != nullptr; count--)
+        {
+            Object* object = _sweepList;
+            _sweepList = object->next;
+
+            if (object->marked)
+            {
+                object->marked = false;
+                object->next = _objects;
+                _objects = object;
+            }
+            else
+            {
+                _oldBytes -= object->size;
+                destroy(object);
+            }
+        }
+
+        if (_sweepList != nullptr)
+        {
+            return false;
+        }
+
+        releaseEmptyBlocks();
+        _phase = Phase::eIdle;
+        _nextCollection = std::max(_oldBytes * kGrowthFactor, kInitialThreshold);
+        _statistics.collections++;
+        return true;
+    }
+
+    void Heap::destroy(Object* object)
+    {
+        _statistics.bytesAllocated -= object->size;
+        _statistics.bytesFreed += object->size;
+        _statistics.objectCount--;
+        _statistics.objectsFreed++;
+
+        if (object->type == ObjectType::eString)
+        {
+            auto* string = static_cast<Objects::String*>(object);
+            auto it = _strings.find(string->value);
+            if (it != _strings.end() && it->second == string)
+            {
+                _strings.erase(it);
+            }
+        }
+
+        Block* block = blockOf(object);
+        object->~Object();
+        block->liveObjects--;
+    }
+
+    auto operator<<(std::ostream& ostr, const HeapStatistics& statistics) -> std::ostream&
+    {
+        ostr << "collections: " << statistics.collections << " full, "
+             << statistics.minorCollections << " minor; heap: " << statistics.bytesAllocated
+             << " bytes in " << statistics.objectCount << " objects (peak "
+             << statistics.peakBytesAllocated << " bytes); promoted: " << statistics.bytesPromoted
+             << " bytes; freed: " << statistics.bytesFreed << " bytes in "
+             << statistics.objectsFreed << " objects; pauses: " << statistics.pauses
+             << " (max " << statistics.maxPause.count() / 1000 << " us, average "
+             << statistics.averagePause().count() / 1000 << " us)";
+        return ostr;
+    }
+}  // namespace sail
@@ -0,0 +1,44 @@
+#include <new>
+
+#include "Memory/ReservedArray.h"
+
+#if defined(_WIN32)
+#    include <windows.h>
+#else
+#    include <sys/mman.h>
+#endif
+
+namespace sail::VirtualMemory
+{
+    auto reserve(size_t bytes) -> void*
+    {
+#if defined(_WIN32)
+        // Committed pages are only given physical memory once touched.
+        void* memory = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+#else
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#    if defined(MAP_NORESERVE)
+        flags |= MAP_NORESERVE;
+#    endif
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+#endif
+        return memory;
+    }
+
+    void release(void* memory, [[maybe_unused]] size_t bytes)
+    {
+#if defined(_WIN32)
+        VirtualFree(memory, 0, MEM_RELEASE);
+#else
+        munmap(memory, bytes);
+#endif
+    }
+}  // namespace sail::VirtualMemory
@@ -1,3 +1,4 @@
+#include <limits>
 #include <memory>
 #include <string_view>
 
@@ -6,6 +7,7 @@
 #include "Native/Functions/PrintFunction.h"
 #include "Native/Functions/TimeFunction.h"
 #include "Types/NullType.h"
+#include "VirtualMachine/VirtualMachine.h"
 
 namespace sail
 {
@@ -20,4 +22,11 @@ namespace sail
         auto seconds = std::make_shared<Native::Functions::Seconds>();
         environment.define(seconds->name(), seconds);
     }
+
+    void defineNativeFunctions(VirtualMachine& machine)
+    {
+        machine.defineNative("print", Native::Functions::print, std::numeric_limits<size_t>::max());
+        machine.defineNative("millis", Native::Functions::millis, 0);
+        machine.defineNative("seconds", Native::Functions::seconds, 0);
+    }
 }  // namespace sail
\ No newline at end of file
@@ -6,7 +6,7 @@ namespace sail::Native::Functions
 {
 
     auto Print::call(Interpreter& /*interpreter*/,
-                     std::vector<Value>& arguments) -> Value
+                     std::span<Value> arguments) -> Value
     {
         for (const auto& argument : arguments)
         {
@@ -24,4 +24,14 @@ namespace sail::Native::Functions
     {
         return _name;
     }
+
+    auto print(VirtualMachine& /*machine*/, std::span<Bytecode::Value> arguments)
+        -> Bytecode::Value
+    {
+        for (const auto& argument : arguments)
+        {
+            std::cout << argument << std::endl;
+        }
+        return {};
+    }
 }  // namespace sail::Native::Functions
\ No newline at end of file
@@ -6,7 +6,7 @@ namespace sail::Native::Functions
 {
 
     auto Millis::call(Interpreter& /*interpreter*/,
-                      std::vector<Value>& arguments) -> Value
+                      std::span<Value> arguments) -> Value
     {
         auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
                         std::chrono::system_clock::now().time_since_epoch())
@@ -26,7 +26,7 @@ namespace sail::Native::Functions
     }
 
     auto Seconds::call(Interpreter& /*interpreter*/,
-                       std::vector<Value>& arguments) -> Value
+                       std::span<Value> arguments) -> Value
     {
         auto time = std::chrono::duration_cast<std::chrono::seconds>(
                         std::chrono::system_clock::now().time_since_epoch())
@@ -44,4 +44,24 @@ namespace sail::Native::Functions
     {
         return _name;
     }
+
+    auto millis(VirtualMachine& /*machine*/, std::span<Bytecode::Value> /*arguments*/)
+        -> Bytecode::Value
+    {
+        auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+
+        return static_cast<double>(time);
+    }
+
+    auto seconds(VirtualMachine& /*machine*/, std::span<Bytecode::Value> /*arguments*/)
+        -> Bytecode::Value
+    {
+        auto time = std::chrono::duration_cast<std::chrono::seconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+
+        return static_cast<double>(time);
+    }
 }  // namespace sail::Native::Functions
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "Objects/ClassObject.h"
+
+namespace sail::Objects
+{
+    auto Class::findMethod(String* methodName) const -> Closure*
+    {
+        auto it = methods.find(methodName);
+        if (it != methods.end())
+        {
+            return it->second;
+        }
+
+        if (superclass != nullptr)
+        {
+            return superclass->findMethod(methodName);
+        }
+
+        return nullptr;
+    }
+}  // namespace sail::Objects
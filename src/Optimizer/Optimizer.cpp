@@ -0,0 +1,483 @@
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "Optimizer/Optimizer.h"
+
+#include "Expressions/Expressions.h"
+#include "Types/Value.h"
+
+namespace sail
+{
+    namespace
+    {
+        auto asLiteral(const std::shared_ptr<Expression>& expression) -> Expressions::Literal*
+        {
+            return dynamic_cast<Expressions::Literal*>(expression.get());
+        }
+
+        auto isNumberLiteral(const std::shared_ptr<Expression>& expression, double number) -> bool
+        {
+            const Expressions::Literal* literal = asLiteral(expression);
+            return literal != nullptr && std::holds_alternative<double>(literal->literal)
+                   && std::get<double>(literal->literal) == number;
+        }
+
+        // Whether the expression evaluates to a number whenever it does not raise an error.
+        auto producesNumber(const std::shared_ptr<Expression>& expression) -> bool
+        {
+            if (const Expressions::Literal* literal = asLiteral(expression))
+            {
+                return std::holds_alternative<double>(literal->literal);
+            }
+            if (const auto* unary = dynamic_cast<const Expressions::Unary*>(expression.get()))
+            {
+                return unary->op.type == TokenType::eMinus;
+            }
+            if (const auto* binary = dynamic_cast<const Expressions::Binary*>(expression.get()))
+            {
+                switch (binary->op.type)
+                {
+                    case TokenType::eMinus:
+                    case TokenType::eSlash:
+                    case TokenType::eStar:
+                        return true;
+                    case TokenType::ePlus:
+                        // Adding two strings concatenates them.
+                        return producesNumber(binary->left) || producesNumber(binary->right);
+                    default:
+                        return false;
+                }
+            }
+            return false;
+        }
+
+        // Whether the expression evaluates to a boolean whenever it does not raise an error.
+        auto producesBool(const std::shared_ptr<Expression>& expression) -> bool
+        {
+            if (const Expressions::Literal* literal = asLiteral(expression))
+            {
+                return std::holds_alternative<bool>(literal->literal);
+            }
+            if (const auto* unary = dynamic_cast<const Expressions::Unary*>(expression.get()))
+            {
+                return unary->op.type == TokenType::eBang;
+            }
+            if (const auto* binary = dynamic_cast<const Expressions::Binary*>(expression.get()))
+            {
+                switch (binary->op.type)
+                {
+                    case TokenType::eBangEqual:
+                    case TokenType::eEqualEqual:
+                    case TokenType::eGreater:
+                    case TokenType::eGreaterEqual:
+                    case TokenType::eLess:
+                    case TokenType::eLessEqual:
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+            return false;
+        }
+
+        // Whether evaluating the expression can neither fail nor affect anything else.
+        auto isPure(const std::shared_ptr<Expression>& expression) -> bool
+        {
+            if (asLiteral(expression) != nullptr
+                || dynamic_cast<const Expressions::This*>(expression.get()) != nullptr)
+            {
+                return true;
+            }
+            if (const auto* variable =
+                    dynamic_cast<const Expressions::Variable*>(expression.get()))
+            {
+                // Reading a global fails when it is not defined.
+                return variable->binding.kind != Expressions::BindingKind::eGlobal;
+            }
+            if (const auto* logical = dynamic_cast<const Expressions::Logical*>(expression.get()))
+            {
+                return isPure(logical->left) && isPure(logical->right);
+            }
+            if (const auto* unary = dynamic_cast<const Expressions::Unary*>(expression.get()))
+            {
+                return unary->op.type == TokenType::eBang && isPure(unary->right);
+            }
+            if (const auto* binary = dynamic_cast<const Expressions::Binary*>(expression.get()))
+            {
+                bool compares = binary->op.type == TokenType::eEqualEqual
+                                || binary->op.type == TokenType::eBangEqual;
+                return compares && isPure(binary->left) && isPure(binary->right);
+            }
+            return false;
+        }
+
+        // Stands in for a branch or loop body that was removed entirely.
+        auto emptyBlock() -> std::shared_ptr<Statement>
+        {
+            return std::make_shared<Statements::Block>(std::vector<std::shared_ptr<Statement>> {});
+        }
+
+        // Mirrors Interpreter::visitBinaryExpression, returning nothing where it would throw.
+        auto foldBinary(TokenType op, const Value& left, const Value& right)
+            -> std::optional<LiteralType>
+        {
+            if (op == TokenType::ePlus && left.isString() && right.isString())
+            {
+                return std::get<std::string>(left) + std::get<std::string>(right);
+            }
+            if (op == TokenType::eBangEqual)
+            {
+                return left != right;
+            }
+            if (op == TokenType::eEqualEqual)
+            {
+                return left == right;
+            }
+
+            std::optional<double> leftNumber = left.asNumber();
+            std::optional<double> rightNumber = right.asNumber();
+            if (!leftNumber.has_value() || !rightNumber.has_value())
+            {
+                return std::nullopt;
+            }
+
+            double leftValue = *leftNumber;
+            double rightValue = *rightNumber;
+            switch (op)
+            {
+                case TokenType::eMinus:
+                    return leftValue - rightValue;
+                case TokenType::eSlash:
+                    return leftValue / rightValue;
+                case TokenType::eStar:
+                    return leftValue * rightValue;
+                case TokenType::ePlus:
+                    return leftValue + rightValue;
+                case TokenType::eGreater:
+                    return leftValue > rightValue;
+                case TokenType::eGreaterEqual:
+                    return leftValue >= rightValue;
+                case TokenType::eLess:
+                    return leftValue < rightValue;
+                case TokenType::eLessEqual:
+                    return leftValue <= rightValue;
+                default:
+                    return std::nullopt;
+            }
+        }
+
+        // Replaces the node with one of its operands. The operand is moved out first, as the
+        // assignment destroys the node that owns it.
+        void replaceWith(std::shared_ptr<Expression>& shared, std::shared_ptr<Expression>& operand)
+        {
+            std::shared_ptr<Expression> replacement = std::move(operand);
+            shared = std::move(replacement);
+        }
+    }  // namespace
+
+    void Optimizer::optimize(std::vector<std::shared_ptr<Statement>>& statements)
+    {
+        std::vector<std::shared_ptr<Statement>> kept;
+        kept.reserve(statements.size());
+        for (std::shared_ptr<Statement>& statement : statements)
+        {
+            optimize(statement);
+            if (statement == nullptr)
+            {
+                continue;
+            }
+
+            kept.push_back(std::move(statement));
+            // Nothing following a return in the same list can run.
+            if (dynamic_cast<Statements::Return*>(kept.back().get()) != nullptr)
+            {
+                break;
+            }
+        }
+        statements = std::move(kept);
+    }
+
+    void Optimizer::optimize(std::shared_ptr<Statement>& statement)
+    {
+        statement->accept(*this, statement);
+    }
+
+    void Optimizer::optimize(std::shared_ptr<Expression>& expression)
+    {
+        expression->accept(*this, expression);
+    }
+
+    void Optimizer::visitBlockStatement(Statements::Block& blockStatement,
+                                        std::shared_ptr<Statement>& shared)
+    {
+        optimize(blockStatement.statements);
+    }
+
+    void Optimizer::visitClassStatement(Statements::Class& classStatement,
+                                        std::shared_ptr<Statement>& shared)
+    {
+        for (std::shared_ptr<Statements::Function>& method : classStatement.methods)
+        {
+            optimizeFunction(*method);
+        }
+    }
+
+    void Optimizer::visitExpressionStatement(Statements::Expression& expressionStatement,
+                                             std::shared_ptr<Statement>& shared)
+    {
+        optimize(expressionStatement.expression);
+    }
+
+    void Optimizer::visitFunctionStatement(Statements::Function& functionStatement,
+                                           std::shared_ptr<Statement>& shared)
+    {
+        optimizeFunction(functionStatement);
+    }
+
+    void Optimizer::visitIfStatement(Statements::If& ifStatement,
+                                     std::shared_ptr<Statement>& shared)
+    {
+        optimize(ifStatement.condition);
+
+        if (const Expressions::Literal* condition = asLiteral(ifStatement.condition))
+        {
+            // Only the branch the condition selects is kept, and nothing if it has no else.
+            std::shared_ptr<Statement> taken = condition->value.isTruthy()
+                                                   ? std::move(ifStatement.thenBranch)
+                                                   : std::move(ifStatement.elseBranch);
+            shared = std::move(taken);
+            if (shared != nullptr)
+            {
+                optimize(shared);
+            }
+            return;
+        }
+
+        optimize(ifStatement.thenBranch);
+        if (ifStatement.thenBranch == nullptr)
+        {
+            ifStatement.thenBranch = emptyBlock();
+        }
+        if (ifStatement.elseBranch != nullptr)
+        {
+            optimize(ifStatement.elseBranch);
+        }
+    }
+
+    void Optimizer::visitReturnStatement(Statements::Return& returnStatement,
+                                         std::shared_ptr<Statement>& shared)
+    {
+        if (returnStatement.value != nullptr)
+        {
+            optimize(returnStatement.value);
+        }
+    }
+
+    void Optimizer::visitVariableStatement(Statements::Variable& variableStatement,
+                                           std::shared_ptr<Statement>& shared)
+    {
+        if (variableStatement.initializer != nullptr)
+        {
+            optimize(variableStatement.initializer);
+        }
+
+        bool unused = variableStatement.binding.kind == Expressions::BindingKind::eLocal
+                      && !variableStatement.referenced;
+        if (unused
+            && (variableStatement.initializer == nullptr || isPure(variableStatement.initializer)))
+        {
+            shared = nullptr;
+        }
+    }
+
+    void Optimizer::visitWhileStatement(Statements::While& whileStatement,
+                                        std::shared_ptr<Statement>& shared)
+    {
+        optimize(whileStatement.condition);
+
+        const Expressions::Literal* condition = asLiteral(whileStatement.condition);
+        if (condition != nullptr && !condition->value.isTruthy())
+        {
+            shared = nullptr;
+            return;
+        }
+
+        optimize(whileStatement.body);
+        if (whileStatement.body == nullptr)
+        {
+            whileStatement.body = emptyBlock();
+        }
+    }
+
+    void Optimizer::visitAssignmentExpression(Expressions::Assignment& assignmentExpression,
+                                              std::shared_ptr<Expression>& shared)
+    {
+        optimize(assignmentExpression.value);
+    }
+
+    void Optimizer::visitBinaryExpression(Expressions::Binary& binaryExpression,
+                                          std::shared_ptr<Expression>& shared)
+    {
+        optimize(binaryExpression.left);
+        optimize(binaryExpression.right);
+
+        const Expressions::Literal* left = asLiteral(binaryExpression.left);
+        const Expressions::Literal* right = asLiteral(binaryExpression.right);
+        if (left != nullptr && right != nullptr)
+        {
+            std::optional<LiteralType> folded =
+                foldBinary(binaryExpression.op.type, left->value, right->value);
+            if (folded.has_value())
+            {
+                shared = std::make_shared<Expressions::Literal>(std::move(*folded));
+            }
+            return;
+        }
+
+        // x + 0 is left alone, as it turns -0 into 0.
+        switch (binaryExpression.op.type)
+        {
+            case TokenType::eStar:
+                if (isNumberLiteral(binaryExpression.right, 1)
+                    && producesNumber(binaryExpression.left))
+                {
+                    replaceWith(shared, binaryExpression.left);
+                }
+                else if (isNumberLiteral(binaryExpression.left, 1)
+                         && producesNumber(binaryExpression.right))
+                {
+                    replaceWith(shared, binaryExpression.right);
+                }
+                return;
+            case TokenType::eSlash:
+                if (isNumberLiteral(binaryExpression.right, 1)
+                    && producesNumber(binaryExpression.left))
+                {
+                    replaceWith(shared, binaryExpression.left);
+                }
+                return;
+            case TokenType::eMinus:
+                if (isNumberLiteral(binaryExpression.right, 0)
+                    && producesNumber(binaryExpression.left))
+                {
+                    replaceWith(shared, binaryExpression.left);
+                }
+                return;
+            default:
+                return;
+        }
+    }
+
+    void Optimizer::visitCallExpression(Expressions::Call& callExpression,
+                                        std::shared_ptr<Expression>& shared)
+    {
+        // Calls and property accesses are never replaced, so the Resolver's pointers to the call
+        // and into its callee stay valid.
+        optimize(callExpression.callee);
+        for (std::shared_ptr<Expression>& argument : callExpression.arguments)
+        {
+            optimize(argument);
+        }
+    }
+
+    void Optimizer::visitGetExpression(Expressions::Get& getExpression,
+                                       std::shared_ptr<Expression>& shared)
+    {
+        optimize(getExpression.object);
+    }
+
+    void Optimizer::visitGroupingExpression(Expressions::Grouping& groupingExpression,
+                                            std::shared_ptr<Expression>& shared)
+    {
+        optimize(groupingExpression.expression);
+        replaceWith(shared, groupingExpression.expression);
+    }
+
+    void Optimizer::visitLiteralExpression(Expressions::Literal& literalExpression,
+                                           std::shared_ptr<Expression>& shared)
+    {
+    }
+
+    void Optimizer::visitLogicalExpression(Expressions::Logical& logicalExpression,
+                                           std::shared_ptr<Expression>& shared)
+    {
+        optimize(logicalExpression.left);
+        optimize(logicalExpression.right);
+
+        const Expressions::Literal* left = asLiteral(logicalExpression.left);
+        if (left == nullptr)
+        {
+            return;
+        }
+
+        // Either operator yields its left operand when that decides the result, and its right
+        // operand otherwise.
+        bool leftDecides = (logicalExpression.op.type == TokenType::eOr) == left->value.isTruthy();
+        replaceWith(shared, leftDecides ? logicalExpression.left : logicalExpression.right);
+    }
+
+    void Optimizer::visitSetExpression(Expressions::Set& setExpression,
+                                       std::shared_ptr<Expression>& shared)
+    {
+        optimize(setExpression.object);
+        optimize(setExpression.value);
+    }
+
+    void Optimizer::visitSuperExpression(Expressions::Super& superExpression,
+                                         std::shared_ptr<Expression>& shared)
+    {
+    }
+
+    void Optimizer::visitThisExpression(Expressions::This& thisExpression,
+                                        std::shared_ptr<Expression>& shared)
+    {
+    }
+
+    void Optimizer::visitUnaryExpression(Expressions::Unary& unaryExpression,
+                                         std::shared_ptr<Expression>& shared)
+    {
+        optimize(unaryExpression.right);
+
+        if (const Expressions::Literal* right = asLiteral(unaryExpression.right))
+        {
+            if (unaryExpression.op.type == TokenType::eBang)
+            {
+                shared = std::make_shared<Expressions::Literal>(!right->value.isTruthy());
+                return;
+            }
+
+            std::optional<double> number = right->value.asNumber();
+            if (unaryExpression.op.type == TokenType::eMinus && number.has_value())
+            {
+                shared = std::make_shared<Expressions::Literal>(-*number);
+            }
+            return;
+        }
+
+        // Negating twice gives back the number, and so does inverting a boolean twice.
+        auto* inner = dynamic_cast<Expressions::Unary*>(unaryExpression.right.get());
+        if (inner == nullptr || inner->op.type != unaryExpression.op.type)
+        {
+            return;
+        }
+
+        bool restores = unaryExpression.op.type == TokenType::eMinus
+                            ? producesNumber(inner->right)
+                            : producesBool(inner->right);
+        if (restores)
+        {
+            replaceWith(shared, inner->right);
+        }
+    }
+
+    void Optimizer::visitVariableExpression(Expressions::Variable& variableExpression,
+                                            std::shared_ptr<Expression>& shared)
+    {
+    }
+
+    void Optimizer::optimizeFunction(Statements::Function& functionStatement)
+    {
+        optimize(functionStatement.body);
+    }
+}  // namespace sail
@@ -1,10 +1,13 @@
 #include "Resolver/Resolver.h"
 
+#include <algorithm>
+#include <utility>
+
 #include <fmt/format.h>
 
 #include "Errors/RuntimeError.h"
 #include "Expressions/Expressions.h"
-#include "Interpreter/Interpreter.h"
+#include "Resolver/Selectors.h"
 #include "magic_enum.hpp"
 #include "utils/Overload.h"
 
@@ -12,8 +15,8 @@ namespace sail
 {
     using namespace magic_enum::bitwise_operators;
 
-    Resolver::Resolver(Interpreter& interpreter)
-        : _interpreter(interpreter)
+    Resolver::Resolver(Selectors& selectors)
+        : _selectors(selectors)
     {
     }
 
@@ -39,8 +42,16 @@ namespace sail
                                        std::shared_ptr<Statement>& shared)
     {
         beginScope();
+        blockStatement.firstSlot = _functions.back().nextSlot;
+        const size_t enclosingMaxSlots = std::exchange(_functions.back().maxSlots,
+                                                       blockStatement.firstSlot);
+
         resolve(blockStatement.statements);
-        endScope();
+
+        FunctionScope& function = _functions.back();
+        blockStatement.slotCount = function.maxSlots - blockStatement.firstSlot;
+        function.maxSlots = std::max(function.maxSlots, enclosingMaxSlots);
+        blockStatement.closesUpvalues = endScope();
     }
 
     void Resolver::visitClassStatement(Statements::Class& classStatement,
@@ -49,7 +60,7 @@ namespace sail
         ClassType enclosingClass = _currentClass;
         _currentClass = ClassType::eClass;
 
-        declare(classStatement.name);
+        classStatement.binding = declare(classStatement.name);
         define(classStatement.name);
 
         if (classStatement.superclass != nullptr)
@@ -66,8 +77,8 @@ namespace sail
             _currentClass |= ClassType::eSubclass;
         }
 
-        beginScope();
-
+        // 'this' and 'super' live in each method's own frame, so the class body does not
+        // introduce a scope of its own.
         for (std::shared_ptr<Statements::Function>& method : classStatement.methods)
         {
             FunctionType functionType = FunctionType::eMethod;
@@ -76,11 +87,10 @@ namespace sail
                 functionType = FunctionType::eInitializer;
             }
 
+            method->selector = _selectors.declare(method->name.lexeme);
             resolveFunction(*method, functionType);
         }
 
-        endScope();
-
         _currentClass = enclosingClass;
     }
 
@@ -93,7 +103,7 @@ namespace sail
     void Resolver::visitFunctionStatement(Statements::Function& functionStatement,
                                           std::shared_ptr<Statement>& shared)
     {
-        declare(functionStatement.name);
+        functionStatement.binding = declare(functionStatement.name);
         define(functionStatement.name);
 
         resolveFunction(functionStatement, FunctionType::eFunction);
@@ -126,6 +136,8 @@ namespace sail
             }
 
             resolve(returnStatement.value);
+            returnStatement.tailCall =
+                dynamic_cast<Expressions::Call*>(returnStatement.value.get());
         }
     }
 
@@ -139,7 +151,11 @@ namespace sail
     void Resolver::visitVariableStatement(Statements::Variable& variableStatement,
                                           std::shared_ptr<Statement>& shared)
     {
-        declare(variableStatement.name);
+        variableStatement.binding = declare(variableStatement.name);
+        if (variableStatement.binding.kind == Expressions::BindingKind::eLocal)
+        {
+            _scopes.back()[variableStatement.name.lexeme].declaration = &variableStatement;
+        }
         if (variableStatement.initializer != nullptr)
         {
             resolve(variableStatement.initializer);
@@ -151,7 +167,7 @@ namespace sail
                                              std::shared_ptr<Expression>& shared)
     {
         resolve(assignmentExpression.value);
-        resolveLocal(shared, assignmentExpression.name);
+        resolveLocal(assignmentExpression.binding, assignmentExpression.name.lexeme);
     }
 
     void Resolver::visitBinaryExpression(Expressions::Binary& binaryExpression,
@@ -165,6 +181,7 @@ namespace sail
                                        std::shared_ptr<Expression>& shared)
     {
         resolve(callExpression.callee);
+        callExpression.property = dynamic_cast<Expressions::Get*>(callExpression.callee.get());
 
         for (auto& argument : callExpression.arguments)
         {
@@ -219,7 +236,8 @@ namespace sail
                                "Cannot use 'super' in a class with no superclass.");
         }
 
-        resolveLocal(shared, superExpression.keyword);
+        resolveLocal(superExpression.binding, superExpression.keyword.lexeme);
+        resolveLocal(superExpression.thisBinding, "this");
     }
 
     void Resolver::visitThisExpression(Expressions::This& thisExpression,
@@ -231,7 +249,7 @@ namespace sail
             throw RuntimeError(thisExpression.keyword, "Cannot use 'this' outside of a class.");
         }
 
-        resolveLocal(shared, thisExpression.keyword);
+        resolveLocal(thisExpression.binding, thisExpression.keyword.lexeme);
     }
 
     void Resolver::visitUnaryExpression(Expressions::Unary& unaryExpression,
@@ -243,14 +261,17 @@ namespace sail
     void Resolver::visitVariableExpression(Expressions::Variable& variableExpression,
                                            std::shared_ptr<Expression>& shared)
     {
-        if (!_scopes.empty() && _scopes.back().contains(variableExpression.name.lexeme)
-            && !_scopes.back()[variableExpression.name.lexeme])
+        if (!_scopes.empty())
         {
-            throw RuntimeError(variableExpression.name,
-                               "Cannot read local variable in its own initializer.");
+            auto it = _scopes.back().find(variableExpression.name.lexeme);
+            if (it != _scopes.back().end() && !it->second.defined)
+            {
+                throw RuntimeError(variableExpression.name,
+                                   "Cannot read local variable in its own initializer.");
+            }
         }
 
-        resolveLocal(shared, variableExpression.name);
+        resolveLocal(variableExpression.binding, variableExpression.name.lexeme);
     }
 
     void Resolver::beginScope()
@@ -258,16 +279,24 @@ namespace sail
         _scopes.emplace_back();
     }
 
-    void Resolver::endScope()
+    auto Resolver::endScope() -> bool
     {
+        bool captured = false;
+        for (const auto& [name, variable] : _scopes.back())
+        {
+            captured |= variable.captured;
+        }
+
+        _functions.back().nextSlot -= _scopes.back().size();
         _scopes.pop_back();
+        return captured;
     }
 
-    void Resolver::declare(const Token& name)
+    auto Resolver::declare(const Token& name) -> Expressions::Binding
     {
         if (_scopes.empty())
         {
-            return;
+            return {};
         }
         auto& scope = _scopes.back();
         if (scope.contains(name.lexeme))
@@ -277,7 +306,7 @@ namespace sail
                 fmt::format("Variable with name '{}' already declared in this scope.",
                             name.lexeme));
         }
-        scope.emplace(name.lexeme, false);
+        return {.kind = Expressions::BindingKind::eLocal, .slot = addVariable(name.lexeme, false)};
     }
 
     void Resolver::define(const Token& name)
@@ -286,19 +315,72 @@ namespace sail
         {
             return;
         }
-        _scopes.back()[name.lexeme] = true;
+        _scopes.back()[name.lexeme].defined = true;
     }
 
-    void Resolver::resolveLocal(std::shared_ptr<Expression>& expression, const Token& name)
+    auto Resolver::addVariable(const std::string& name, bool defined) -> size_t
+    {
+        FunctionScope& function = _functions.back();
+        size_t slot = function.nextSlot++;
+        function.maxSlots = std::max(function.maxSlots, function.nextSlot);
+        _scopes.back().emplace(name, Variable {.defined = defined, .slot = slot});
+        return slot;
+    }
+
+    void Resolver::resolveLocal(Expressions::Binding& binding, const std::string& name)
     {
         for (int64_t i = static_cast<int64_t>(_scopes.size()) - 1; i >= 0; i--)
         {
-            if (_scopes[i].contains(name.lexeme))
+            auto it = _scopes[i].find(name);
+            if (it == _scopes[i].end())
+            {
+                continue;
+            }
+
+            if (it->second.declaration != nullptr)
+            {
+                it->second.declaration->referenced = true;
+            }
+
+            // The innermost function whose scopes include the one declaring the variable.
+            size_t owner = _functions.size() - 1;
+            while (_functions[owner].firstScope > static_cast<size_t>(i))
+            {
+                owner--;
+            }
+
+            if (owner == _functions.size() - 1)
             {
-                _interpreter.resolve(expression, _scopes.size() - 1 - i);
+                binding = {.kind = Expressions::BindingKind::eLocal, .slot = it->second.slot};
                 return;
             }
+
+            it->second.captured = true;
+            binding = {.kind = Expressions::BindingKind::eUpvalue,
+                       .slot = addCapture(_functions.size() - 1, owner, it->second.slot)};
+            return;
+        }
+    }
+
+    auto Resolver::addCapture(size_t function, size_t owner, size_t slot) -> size_t
+    {
+        // Functions between the owner and the one using the variable capture it as well, so that
+        // each closure can take it from the closure creating it.
+        Statements::Capture capture {.isLocal = true, .index = slot};
+        if (function - 1 != owner)
+        {
+            capture = {.isLocal = false, .index = addCapture(function - 1, owner, slot)};
+        }
+
+        std::vector<Statements::Capture>& captures = _functions[function].declaration->captures;
+        auto it = std::ranges::find(captures, capture);
+        if (it != captures.end())
+        {
+            return static_cast<size_t>(it - captures.begin());
         }
+
+        captures.push_back(capture);
+        return captures.size() - 1;
     }
 
     void Resolver::resolveFunction(Statements::Function& function, FunctionType type)
@@ -306,6 +388,7 @@ namespace sail
         FunctionType enclosingFunction = _currentFunction;
         _currentFunction = type;
 
+        _functions.push_back({.firstScope = _scopes.size(), .declaration = &function});
         beginScope();
         for (Token& param : function.parameters)
         {
@@ -315,18 +398,51 @@ namespace sail
 
         if (type == FunctionType::eMethod || type == FunctionType::eInitializer)
         {
-            _scopes.back().emplace("this", true);
+            addVariable("this", true);
 
             const bool isSubclass = static_cast<bool>(_currentClass & ClassType::eSubclass);
             if (isSubclass)
             {
-                _scopes.back().emplace("super", true);
+                addVariable("super", true);
             }
         }
 
         resolve(function.body);
+        // Initializers return the instance rather than what they end with.
+        if (type != FunctionType::eInitializer && !function.body.empty())
+        {
+            markTailCall(*function.body.back());
+        }
         endScope();
+        function.slotCount = _functions.back().maxSlots;
+        _functions.pop_back();
 
         _currentFunction = enclosingFunction;
     }
+
+    void Resolver::markTailCall(Statement& statement)
+    {
+        // A loop runs its body again, so only the last statement of blocks and branches ends the
+        // function.
+        if (auto* expressionStatement = dynamic_cast<Statements::Expression*>(&statement))
+        {
+            expressionStatement->tailCall =
+                dynamic_cast<Expressions::Call*>(expressionStatement->expression.get());
+        }
+        else if (auto* blockStatement = dynamic_cast<Statements::Block*>(&statement))
+        {
+            if (!blockStatement->statements.empty())
+            {
+                markTailCall(*blockStatement->statements.back());
+            }
+        }
+        else if (auto* ifStatement = dynamic_cast<Statements::If*>(&statement))
+        {
+            markTailCall(*ifStatement->thenBranch);
+            if (ifStatement->elseBranch != nullptr)
+            {
+                markTailCall(*ifStatement->elseBranch);
+            }
+        }
+    }
 }  // namespace sail
@@ -0,0 +1,26 @@
+#include "Resolver/Selectors.h"
+
+namespace sail
+{
+    Selectors::Selectors()
+    {
+        declare("init");
+    }
+
+    auto Selectors::declare(const std::string& name) -> Selector
+    {
+        auto [it, inserted] = _selectors.try_emplace(name, static_cast<Selector>(_selectors.size()));
+        return it->second;
+    }
+
+    auto Selectors::find(const std::string& name) const -> Selector
+    {
+        auto it = _selectors.find(name);
+        if (it == _selectors.end())
+        {
+            return kNone;
+        }
+
+        return it->second;
+    }
+}  // namespace sail
@@ -8,21 +8,33 @@ namespace sail::Types
 {
     Class::Class(std::string name,
                  std::shared_ptr<Types::Class> superclass,
-
-                 ankerl::unordered_dense::map<std::string, std::shared_ptr<Function>> methods)
+                 const std::vector<std::shared_ptr<Function>>& methods)
         : _name(std::move(name))
         , _superclass(std::move(superclass))
-        , _methods(std::move(methods))
     {
+        if (_superclass != nullptr)
+        {
+            _methods = _superclass->_methods;
+        }
+
+        for (const std::shared_ptr<Function>& method : methods)
+        {
+            if (method->selector() >= _methods.size())
+            {
+                _methods.resize(method->selector() + 1);
+            }
+            _methods[method->selector()] = method;
+        }
+
+        _initializer = findMethod(Selectors::kInitializer);
     }
 
-    auto Class::call(Interpreter& interpreter, std::vector<Value>& arguments) -> Value
+    auto Class::call(Interpreter& interpreter, std::span<Value> arguments) -> Value
     {
         auto instance = std::make_shared<Instance>(shared_from_this());
-        auto initializer = findMemberFunction("init");
-        if (initializer != nullptr)
+        if (_initializer != nullptr)
         {
-            initializer->call(interpreter, arguments, instance);
+            _initializer->call(interpreter, arguments, instance);
         }
 
         return {instance};
@@ -30,13 +42,12 @@ namespace sail::Types
 
     auto Class::arity() const -> size_t
     {
-        auto initializer = findMemberFunction("init");
-        if (initializer == nullptr)
+        if (_initializer == nullptr)
         {
             return 0;
         }
 
-        return initializer->arity();
+        return _initializer->arity();
     }
 
     auto Class::name() const -> std::string const&
@@ -44,18 +55,15 @@ namespace sail::Types
         return _name;
     }
 
-    auto Class::findMemberFunction(const std::string& name) const -> std::shared_ptr<Function>
+    auto Class::findMethod(Selector selector) const -> const std::shared_ptr<Function>&
     {
-        if (_methods.contains(name))
-        {
-            return _methods.at(name);
-        }
+        static const std::shared_ptr<Function> kNoMethod;
 
-        if (_superclass != nullptr)
+        if (selector >= _methods.size())
         {
-            return _superclass->findMemberFunction(name);
+            return kNoMethod;
         }
 
-        return nullptr;
+        return _methods[selector];
     }
 }  // namespace sail::Types
\ No newline at end of file
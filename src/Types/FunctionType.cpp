@@ -3,34 +3,32 @@
 #include "Types/FunctionType.h"
 
 #include "Interpreter/Interpreter.h"
-#include "Types/NullType.h"
 
 namespace sail::Types
 {
     Function::Function(std::shared_ptr<Statements::Function> body,
-                       std::shared_ptr<Environment> closure,
-                       bool isInitializer)
+                       std::vector<std::shared_ptr<Upvalue>> upvalues,
+                       bool isInitializer,
+                       std::shared_ptr<Class> superclass,
+                       std::shared_ptr<const CompiledStatement> compiledBody)
         : _body(std::move(body))
-        , _closure(std::move(closure))
+        , _upvalues(std::move(upvalues))
+        , _superclass(std::move(superclass))
+        , _compiledBody(std::move(compiledBody))
         , _isInitializer(isInitializer)
     {
     }
 
-    auto Function::call(Interpreter& interpreter, std::vector<Value>& arguments) -> Value
+    auto Function::call(Interpreter& interpreter, std::span<Value> arguments) -> Value
     {
-        auto environment = std::make_shared<Environment>(_closure);
-
-        return process(interpreter, arguments, environment);
+        return interpreter.callFunction(*this, arguments, nullptr);
     }
 
     auto Function::call(Interpreter& interpreter,
-                        std::vector<Value>& arguments,
+                        std::span<Value> arguments,
                         std::shared_ptr<Instance> instance) -> Value
     {
-        auto environment = std::make_shared<Environment>(_closure);
-        environment->define("this", instance);
-
-        return process(interpreter, arguments, environment);
+        return interpreter.callFunction(*this, arguments, std::move(instance));
     }
 
     auto Function::arity() const -> size_t
@@ -43,30 +41,4 @@ namespace sail::Types
         return _body->name.lexeme;
     }
 
-    auto Function::process(Interpreter& interpreter,
-                           std::vector<Value>& arguments,
-                           std::shared_ptr<Environment>& environment) -> Value
-    {
-        for (size_t i = 0; i < _body->parameters.size(); i++)
-        {
-            environment->define(_body->parameters[i].lexeme, arguments[i]);
-        }
-
-        try
-        {
-            interpreter.executeBlock(_body->body, environment);
-        }
-        catch (Return& returnValue)
-        {
-            if (_isInitializer)
-            {
-                return environment->getAt(0, "this");
-            }
-
-            return returnValue.value();
-        }
-
-        return Types::Null {};
-    }
-
-}  // namespace sail::Types
\ No newline at end of file
+}  // namespace sail::Types
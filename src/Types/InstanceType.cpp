@@ -1,4 +1,5 @@
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include "Types/InstanceType.h"
@@ -13,30 +14,62 @@ namespace sail::Types
 {
     Instance::Instance(std::shared_ptr<Class> klass)
         : _klass(std::move(klass))
+        , _shape(_klass->rootShape())
     {
+        _fields.reserve(_klass->expectedFieldCount());
     }
 
-    auto Instance::get(const Token& name) -> Value
+    auto Instance::resolveGet(const Token& name, Selector selector) const
+        -> Expressions::PropertyCacheEntry
     {
-        if (_fields.contains(name.lexeme))
+        if (std::optional<size_t> slot = _shape->slotOf(name.lexeme))
         {
-            return _fields[name.lexeme];
+            return {.shape = _shape, .klass = _klass, .slot = *slot};
         }
 
-        std::shared_ptr<Function> function = _klass->findMemberFunction(name.lexeme);
+        const std::shared_ptr<Function>& function = _klass->findMethod(selector);
         if (function != nullptr)
         {
-            auto method = std::make_shared<Method>(shared_from_this(), function);
-            set(name, {method});
-            return {method};
+            return {.shape = _shape, .klass = _klass, .method = function};
         }
 
         throw RuntimeError(name, fmt::format("Undefined property '{}'.", name.lexeme));
     }
 
-    auto Instance::set(const Token& name, Value value) -> void
+    auto Instance::resolveSet(const Token& name) const -> Expressions::PropertyCacheEntry
     {
-        _fields[name.lexeme] = std::move(value);
+        if (std::optional<size_t> slot = _shape->slotOf(name.lexeme))
+        {
+            return {.shape = _shape, .klass = _klass, .slot = *slot};
+        }
+
+        return {.shape = _shape,
+                .klass = _klass,
+                .slot = _fields.size(),
+                .transition = _shape->withField(name.lexeme)};
+    }
+
+    auto Instance::get(const Expressions::PropertyCacheEntry& entry) -> Value
+    {
+        if (std::shared_ptr<Function> method = entry.method.lock())
+        {
+            return {std::make_shared<Method>(shared_from_this(), std::move(method))};
+        }
+
+        return _fields[entry.slot];
+    }
+
+    void Instance::set(const Expressions::PropertyCacheEntry& entry, Value value)
+    {
+        if (entry.transition == nullptr)
+        {
+            _fields[entry.slot] = std::move(value);
+            return;
+        }
+
+        _shape = entry.transition;
+        _fields.push_back(std::move(value));
+        _klass->noteFieldCount(_fields.size());
     }
 
     auto Instance::toString() const -> std::string
@@ -14,7 +14,7 @@ namespace sail::Types
     {
     }
 
-    auto Method::call(Interpreter& interpreter, std::vector<Value>& arguments)
+    auto Method::call(Interpreter& interpreter, std::span<Value> arguments)
         -> Value
     {
         return _function->call(interpreter, arguments, _instance);
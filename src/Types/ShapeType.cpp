@@ -0,0 +1,32 @@
+#include "Types/ShapeType.h"
+
+namespace sail::Types
+{
+    Shape::Shape(const Shape& parent, const std::string& name)
+        : _slots(parent._slots)
+    {
+        _slots.emplace(name, _slots.size());
+    }
+
+    auto Shape::slotOf(const std::string& name) const -> std::optional<size_t>
+    {
+        auto it = _slots.find(name);
+        if (it == _slots.end())
+        {
+            return std::nullopt;
+        }
+
+        return it->second;
+    }
+
+    auto Shape::withField(const std::string& name) -> Shape*
+    {
+        auto it = _transitions.find(name);
+        if (it == _transitions.end())
+        {
+            it = _transitions.emplace(name, std::unique_ptr<Shape>(new Shape(*this, name))).first;
+        }
+
+        return it->second.get();
+    }
+}  // namespace sail::Types
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "VirtualMachine/DispatchStatistics.h"
+
+#include "magic_enum.hpp"
+
+namespace sail
+{
+    namespace
+    {
+        constexpr size_t kPairsShown = 10;
+
+        auto nameOf(size_t opCode) -> std::string
+        {
+            return std::string(magic_enum::enum_name(static_cast<Bytecode::OpCode>(opCode)));
+        }
+    }  // namespace
+
+    auto DispatchStatistics::total() const -> uint64_t
+    {
+        return std::accumulate(instructions.begin(), instructions.end(), uint64_t {0});
+    }
+
+    auto operator<<(std::ostream& ostr, const DispatchStatistics& statistics) -> std::ostream&
+    {
+        if (statistics.total() == 0)
+        {
+            ostr << "dispatches: none recorded (build with dispatch_stats to count them)";
+            return ostr;
+        }
+
+        using Count = std::tuple<uint64_t, size_t, size_t>;
+        std::vector<Count> opCodes;
+        std::vector<Count> pairs;
+        for (size_t first = 0; first < DispatchStatistics::kOpCodes; first++)
+        {
+            if (statistics.instructions[first] != 0)
+            {
+                opCodes.emplace_back(statistics.instructions[first], first, 0);
+            }
+            for (size_t second = 0; second < DispatchStatistics::kOpCodes; second++)
+            {
+                if (statistics.pairs[first][second] != 0)
+                {
+                    pairs.emplace_back(statistics.pairs[first][second], first, second);
+                }
+            }
+        }
+        std::ranges::sort(opCodes, std::greater {});
+        std::ranges::sort(pairs, std::greater {});
+        pairs.resize(std::min(pairs.size(), kPairsShown));
+
+        ostr << "dispatches: " << statistics.total();
+        for (const auto& [count, opCode, unused] : opCodes)
+        {
+            ostr << "\n  " << nameOf(opCode) << ": " << count;
+        }
+        ostr << "\nmost frequent pairs:";
+        for (const auto& [count, first, second] : pairs)
+        {
+            ostr << "\n  " << nameOf(first) << " -> " << nameOf(second) << ": " << count;
+        }
+        return ostr;
+    }
+}  // namespace sail
@@ -0,0 +1,1154 @@
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include "VirtualMachine/VirtualMachine.h"
+
+#include "Bytecode/OpCode.h"
+#include "Errors/RuntimeError.h"
+#include "Native/DefineNative.h"
+#include "fmt/format.h"
+
+// Threaded dispatch jumps from the end of each instruction straight to the handler of the next one
+// through a table of label addresses, a GCC and Clang extension. Every opcode then has its own
+// indirect branch for the predictor to learn, instead of all of them sharing the switch's. The
+// switch stays as the portable fallback.
+#ifdef SAIL_DISPATCH_STATS
+#    define SAIL_FETCH() recordDispatch(readByte())
+#else
+#    define SAIL_FETCH() readByte()
+#endif
+
+#if defined(SAIL_THREADED_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+#    define SAIL_USE_THREADED_DISPATCH 1
+#    define SAIL_DISPATCH_LOOP goto* kDispatchTable[SAIL_FETCH()];
+#    define SAIL_OPCODE(name) op_##name
+#    define SAIL_NEXT() goto* kDispatchTable[SAIL_FETCH()]
+#else
+#    define SAIL_USE_THREADED_DISPATCH 0
+#    define SAIL_DISPATCH_LOOP while (true) switch (static_cast<OpCode>(SAIL_FETCH()))
+#    define SAIL_OPCODE(name) case OpCode::name
+#    define SAIL_NEXT() break
+#endif
+
+namespace sail
+{
+    using Bytecode::OpCode;
+
+    VirtualMachine::VirtualMachine(size_t maxCallDepth)
+        // The script's own frame comes on top of the calls.
+        : _stack((maxCallDepth + 1) * kFrameSlots)
+        , _stackTop(_stack.get())
+        , _frames(maxCallDepth + 1)
+    {
+        _heap.addRoots(this);
+        _initString = intern("init");
+        defineNativeFunctions(*this);
+    }
+
+    VirtualMachine::~VirtualMachine()
+    {
+        _heap.removeRoots(this);
+    }
+
+    void VirtualMachine::interpret(Objects::Function* script)
+    {
+        try
+        {
+            // Keep the script reachable while its closure is allocated.
+            push(script);
+            auto* closure = allocate<Objects::Closure>(script);
+            _stackTop[-1] = closure;
+            call(closure, 0);
+            if (_frameCount > 0)
+            {
+                run();
+            }
+        }
+        catch (...)
+        {
+            resetStack();
+            throw;
+        }
+    }
+
+    void VirtualMachine::enableJit([[maybe_unused]] size_t callThreshold,
+                                   [[maybe_unused]] size_t loopThreshold)
+    {
+#if SAIL_JIT_SUPPORTED
+        _jit = std::make_unique<JitCompiler>(&compiledSlowPath);
+        _jitThreshold = callThreshold;
+        _jitLoopThreshold = loopThreshold;
+#endif
+    }
+
+    auto VirtualMachine::globalSlot(const std::string& name) -> uint16_t
+    {
+        auto it = _globalSlots.find(name);
+        if (it != _globalSlots.end())
+        {
+            return it->second;
+        }
+
+        if (_globals.size() > std::numeric_limits<uint16_t>::max())
+        {
+            throw std::runtime_error("Too many global variables");
+        }
+
+        auto slot = static_cast<uint16_t>(_globals.size());
+        _globals.push_back({.name = name});
+        _globalSlots.emplace(name, slot);
+        return slot;
+    }
+
+    void VirtualMachine::defineNative(const std::string& name,
+                                      Objects::NativeFunction function,
+                                      size_t arity)
+    {
+        Global& global = _globals[globalSlot(name)];
+        global.value = allocate<Objects::Native>(function, arity, name);
+        global.defined = true;
+    }
+
+    void VirtualMachine::markRoots(Heap& heap)
+    {
+        for (Bytecode::Value* slot = _stack.get(); slot < _stackTop; slot++)
+        {
+            heap.markValue(*slot);
+        }
+        for (size_t i = 0; i < _frameCount; i++)
+        {
+            heap.markObject(_frames[i].closure);
+        }
+        for (Objects::Upvalue* upvalue = _openUpvalues; upvalue != nullptr;
+             upvalue = upvalue->nextOpen)
+        {
+            heap.markObject(upvalue);
+        }
+        heap.markObject(_initString);
+        for (Global& global : _globals)
+        {
+            heap.markValue(global.value);
+        }
+    }
+
+    void VirtualMachine::run(size_t exitDepth)
+    {
+        CallFrame* frame = &_frames[_frameCount - 1];
+        uint8_t* ip = frame->ip;
+        Bytecode::Value* slots = frame->slots;
+
+        auto readByte = [&]() -> uint8_t { return *ip++; };
+        auto readShort = [&]() -> uint16_t
+        {
+            ip += 2;
+            return static_cast<uint16_t>((ip[-2] << 8U) | ip[-1]);
+        };
+        auto readConstant = [&]() -> Bytecode::Value&
+        { return frame->closure->function->chunk.constants[readShort()]; };
+        auto readString = [&]() -> Objects::String* { return readConstant().as<Objects::String>(); };
+#ifdef SAIL_DISPATCH_STATS
+        auto recordDispatch = [&](uint8_t opCode) -> uint8_t
+        {
+            _dispatchStatistics.record(opCode);
+            return opCode;
+        };
+#endif
+
+        // Frames are only switched by calls and returns; everything else works on the cached copies.
+        auto loadFrame = [&]()
+        {
+            frame = &_frames[_frameCount - 1];
+            ip = frame->ip;
+            slots = frame->slots;
+        };
+        auto fail = [&](const std::string& message)
+        {
+            frame->ip = ip;
+            runtimeError(message);
+        };
+
+        // Ends a fused comparison: a failed one jumps, leaving false for the code there to pop.
+        auto jumpIfFalse = [&](uint16_t offset)
+        {
+            if (_stackTop[-1].asBool())
+            {
+                _stackTop--;
+                return;
+            }
+            ip += offset;
+        };
+
+        auto arithmetic = [&](auto operation)
+        {
+            Bytecode::Value right = _stackTop[-1];
+            Bytecode::Value left = _stackTop[-2];
+            if (left.isNumber() && right.isNumber()) [[likely]]
+            {
+                _stackTop[-2] = Bytecode::Value(operation(left.asNumber(), right.asNumber()));
+                _stackTop--;
+                return;
+            }
+
+            std::optional<double> leftNumber = left.toNumber();
+            std::optional<double> rightNumber = right.toNumber();
+            if (!leftNumber.has_value() || !rightNumber.has_value()) [[unlikely]]
+            {
+                fail("Cannot perform arithmetic on non-numbers");
+            }
+
+            _stackTop[-2] = Bytecode::Value(operation(*leftNumber, *rightNumber));
+            _stackTop--;
+        };
+
+#if SAIL_USE_THREADED_DISPATCH
+        // Indexed by opcode, so the order has to follow the OpCode enum.
+        static void* const kDispatchTable[] = {
+            &&op_eConstant,
+            &&op_eNull,
+            &&op_eTrue,
+            &&op_eFalse,
+            &&op_ePop,
+            &&op_eGetLocal,
+            &&op_eSetLocal,
+            &&op_eGetGlobal,
+            &&op_eDefineGlobal,
+            &&op_eSetGlobal,
+            &&op_eGetUpvalue,
+            &&op_eSetUpvalue,
+            &&op_eGetProperty,
+            &&op_eSetProperty,
+            &&op_eGetSuper,
+            &&op_eEqual,
+            &&op_eNotEqual,
+            &&op_eGreater,
+            &&op_eGreaterEqual,
+            &&op_eLess,
+            &&op_eLessEqual,
+            &&op_eAdd,
+            &&op_eSubtract,
+            &&op_eMultiply,
+            &&op_eDivide,
+            &&op_eNot,
+            &&op_eNegate,
+            &&op_eJump,
+            &&op_eJumpIfFalse,
+            &&op_eLoop,
+            &&op_eCall,
+            &&op_eTailCall,
+            &&op_eClosure,
+            &&op_eCloseUpvalue,
+            &&op_eReturn,
+            &&op_eClass,
+            &&op_eInherit,
+            &&op_eMethod,
+            &&op_eGetLocalConstant,
+            &&op_eIncrementLocal,
+            &&op_eSetLocalPop,
+            &&op_eLessJumpIfFalse,
+            &&op_eGreaterJumpIfFalse,
+        };
+        static_assert(std::size(kDispatchTable) == Bytecode::kOpCodeCount);
+#endif
+
+        SAIL_DISPATCH_LOOP
+        {
+            SAIL_OPCODE(eConstant):
+                push(readConstant());
+                SAIL_NEXT();
+            SAIL_OPCODE(eNull):
+                push(Bytecode::Value());
+                SAIL_NEXT();
+            SAIL_OPCODE(eTrue):
+                push(Bytecode::Value(true));
+                SAIL_NEXT();
+            SAIL_OPCODE(eFalse):
+                push(Bytecode::Value(false));
+                SAIL_NEXT();
+            SAIL_OPCODE(ePop):
+                _stackTop--;
+                SAIL_NEXT();
+
+            SAIL_OPCODE(eGetLocal):
+                push(slots[readByte()]);
+                SAIL_NEXT();
+            SAIL_OPCODE(eSetLocal):
+                slots[readByte()] = peek(0);
+                SAIL_NEXT();
+            SAIL_OPCODE(eGetGlobal):
+            {
+                Global& global = _globals[readShort()];
+                if (!global.defined) [[unlikely]]
+                {
+                    fail(fmt::format("Attempted to get undefined variable '{}'", global.name));
+                }
+                push(global.value);
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eDefineGlobal):
+            {
+                Global& global = _globals[readShort()];
+                global.value = pop();
+                global.defined = true;
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eSetGlobal):
+            {
+                Global& global = _globals[readShort()];
+                if (!global.defined) [[unlikely]]
+                {
+                    fail(fmt::format("Attempted to assign undefined variable '{}'",
+                                     global.name));
+                }
+                global.value = peek(0);
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eGetUpvalue):
+                push(*frame->closure->upvalues[readByte()]->location);
+                SAIL_NEXT();
+            SAIL_OPCODE(eSetUpvalue):
+            {
+                Objects::Upvalue* upvalue = frame->closure->upvalues[readByte()];
+                *upvalue->location = peek(0);
+                _heap.writeBarrier(upvalue, peek(0));
+                SAIL_NEXT();
+            }
+            // The instructions below share their implementation with compiled code. They report
+            // errors through the frame, so its ip is stored first.
+            SAIL_OPCODE(eGetProperty):
+            {
+                Objects::String* name = readString();
+                frame->ip = ip;
+                getProperty(name);
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eSetProperty):
+            {
+                Objects::String* name = readString();
+                frame->ip = ip;
+                setProperty(name);
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eGetSuper):
+            {
+                Objects::String* name = readString();
+                frame->ip = ip;
+                getSuper(name);
+                SAIL_NEXT();
+            }
+
+            SAIL_OPCODE(eEqual):
+            {
+                Bytecode::Value right = pop();
+                _stackTop[-1] = Bytecode::Value(_stackTop[-1] == right);
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eNotEqual):
+            {
+                Bytecode::Value right = pop();
+                _stackTop[-1] = Bytecode::Value(!(_stackTop[-1] == right));
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eGreater):
+                arithmetic([](double left, double right) { return left > right; });
+                SAIL_NEXT();
+            SAIL_OPCODE(eGreaterEqual):
+                arithmetic([](double left, double right) { return left >= right; });
+                SAIL_NEXT();
+            SAIL_OPCODE(eLess):
+                arithmetic([](double left, double right) { return left < right; });
+                SAIL_NEXT();
+            SAIL_OPCODE(eLessEqual):
+                arithmetic([](double left, double right) { return left <= right; });
+                SAIL_NEXT();
+            SAIL_OPCODE(eAdd):
+                // Numbers are tested first, as arithmetic would, so adding them skips the two
+                // string checks.
+                if (!(peek(0).isNumber() && peek(1).isNumber())
+                    && peek(0).isObjectType(ObjectType::eString)
+                    && peek(1).isObjectType(ObjectType::eString))
+                {
+                    concatenate();
+                    SAIL_NEXT();
+                }
+                arithmetic([](double left, double right) { return left + right; });
+                SAIL_NEXT();
+            SAIL_OPCODE(eSubtract):
+                arithmetic([](double left, double right) { return left - right; });
+                SAIL_NEXT();
+            SAIL_OPCODE(eMultiply):
+                arithmetic([](double left, double right) { return left * right; });
+                SAIL_NEXT();
+            SAIL_OPCODE(eDivide):
+                arithmetic([](double left, double right) { return left / right; });
+                SAIL_NEXT();
+            SAIL_OPCODE(eNot):
+                _stackTop[-1] = Bytecode::Value(!_stackTop[-1].isTruthy());
+                SAIL_NEXT();
+            SAIL_OPCODE(eNegate):
+            {
+                std::optional<double> number = peek(0).toNumber();
+                if (!number.has_value()) [[unlikely]]
+                {
+                    fail("Cannot negate a non-number");
+                }
+                _stackTop[-1] = Bytecode::Value(-*number);
+                SAIL_NEXT();
+            }
+
+            SAIL_OPCODE(eJump):
+            {
+                uint16_t offset = readShort();
+                ip += offset;
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eJumpIfFalse):
+            {
+                uint16_t offset = readShort();
+                if (!peek(0).isTruthy())
+                {
+                    ip += offset;
+                }
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eLoop):
+            {
+                uint16_t offset = readShort();
+                ip -= offset;
+#if SAIL_JIT_SUPPORTED
+                Objects::Function& function = *frame->closure->function;
+                if (_jit && ++function.backEdgeCount >= _jitLoopThreshold) [[unlikely]]
+                {
+                    function.backEdgeCount = 0;
+                    frame->ip = ip;
+                    size_t depth = _frameCount;
+                    if (runCompiledLoop(*frame, ip))
+                    {
+                        // The frame has either returned or moved on to a tail call.
+                        if (_frameCount < depth && (_frameCount == 0 || _frameCount == exitDepth))
+                        {
+                            return;
+                        }
+                        loadFrame();
+                    }
+                }
+#endif
+                SAIL_NEXT();
+            }
+
+            SAIL_OPCODE(eCall):
+            {
+                uint8_t argumentCount = readByte();
+                frame->ip = ip;
+                callValue(peek(argumentCount), argumentCount);
+                loadFrame();
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eTailCall):
+            {
+                uint8_t argumentCount = readByte();
+                bool discardResult = readByte() != 0;
+                frame->ip = ip;
+#if SAIL_JIT_SUPPORTED
+                size_t depth = _frameCount;
+                tailCall(argumentCount, discardResult);
+                // A compiled callee may have run the frame to its return already.
+                if (_frameCount == depth && frame->ip == frame->closure->function->chunk.code.data()
+                    && frame->closure->function->compiled != nullptr
+                    && _compiledDepth < kCompiledDepthMax)
+                {
+                    runCompiled(*frame);
+                }
+                if (_frameCount < depth && (_frameCount == 0 || _frameCount == exitDepth))
+                {
+                    return;
+                }
+#else
+                tailCall(argumentCount, discardResult);
+#endif
+                loadFrame();
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eClosure):
+            {
+                auto* function = readConstant().as<Objects::Function>();
+                makeClosure(function, ip, *frame);
+                ip += 2 * function->upvalueCount;
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eCloseUpvalue):
+                closeUpvalues(_stackTop - 1);
+                _stackTop--;
+                SAIL_NEXT();
+            SAIL_OPCODE(eReturn):
+            {
+                Bytecode::Value result = pop();
+                if (frame->discardsResult) [[unlikely]]
+                {
+                    result = Bytecode::Value();
+                }
+                closeUpvalues(slots);
+                _frameCount--;
+                if (_frameCount == 0)
+                {
+                    _stackTop = slots;
+                    return;
+                }
+
+                _stackTop = slots;
+                push(result);
+                if (_frameCount == exitDepth)
+                {
+                    return;
+                }
+                loadFrame();
+                SAIL_NEXT();
+            }
+
+            SAIL_OPCODE(eClass):
+                push(allocate<Objects::Class>(readString()->value));
+                SAIL_NEXT();
+            SAIL_OPCODE(eInherit):
+                frame->ip = ip;
+                inherit();
+                SAIL_NEXT();
+            SAIL_OPCODE(eMethod):
+                defineMethod(readString());
+                SAIL_NEXT();
+
+            SAIL_OPCODE(eGetLocalConstant):
+                push(slots[readByte()]);
+                push(readConstant());
+                SAIL_NEXT();
+            SAIL_OPCODE(eIncrementLocal):
+            {
+                Bytecode::Value& local = slots[readByte()];
+                Bytecode::Value increment = readConstant();
+                if (local.isNumber()) [[likely]]
+                {
+                    local = Bytecode::Value(local.asNumber() + increment.asNumber());
+                    SAIL_NEXT();
+                }
+
+                push(local);
+                push(increment);
+                arithmetic([](double left, double right) { return left + right; });
+                local = pop();
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eSetLocalPop):
+                slots[readByte()] = pop();
+                SAIL_NEXT();
+            SAIL_OPCODE(eLessJumpIfFalse):
+            {
+                uint16_t offset = readShort();
+                arithmetic([](double left, double right) { return left < right; });
+                jumpIfFalse(offset);
+                SAIL_NEXT();
+            }
+            SAIL_OPCODE(eGreaterJumpIfFalse):
+            {
+                uint16_t offset = readShort();
+                arithmetic([](double left, double right) { return left > right; });
+                jumpIfFalse(offset);
+                SAIL_NEXT();
+            }
+        }
+    }
+
+    void VirtualMachine::callValue(Bytecode::Value callee, uint8_t argumentCount)
+    {
+        if (callee.isObject()) [[likely]]
+        {
+            switch (callee.asObject()->type)
+            {
+                case ObjectType::eClosure:
+                    call(callee.as<Objects::Closure>(), argumentCount);
+                    return;
+                case ObjectType::eBoundMethod:
+                {
+                    auto* bound = callee.as<Objects::BoundMethod>();
+                    _stackTop[-argumentCount - 1] = bound->receiver;
+                    call(bound->method, argumentCount);
+                    return;
+                }
+                case ObjectType::eClass:
+                {
+                    auto* klass = callee.as<Objects::Class>();
+                    _stackTop[-argumentCount - 1] = allocate<Objects::Instance>(klass);
+
+                    Objects::Closure* initializer = klass->findMethod(_initString);
+                    if (initializer != nullptr)
+                    {
+                        call(initializer, argumentCount);
+                    }
+                    else if (argumentCount != 0) [[unlikely]]
+                    {
+                        runtimeError(
+                            fmt::format("Expected 0 arguments but got {}", argumentCount));
+                    }
+                    return;
+                }
+                case ObjectType::eNative:
+                {
+                    auto* native = callee.as<Objects::Native>();
+                    if (native->arity != argumentCount
+                        && native->arity != std::numeric_limits<size_t>::max()) [[unlikely]]
+                    {
+                        runtimeError(fmt::format(
+                            "Expected {} arguments but got {}", native->arity, argumentCount));
+                    }
+
+                    Bytecode::Value result = native->function(
+                        *this, std::span<Bytecode::Value>(_stackTop - argumentCount, argumentCount));
+                    _stackTop -= argumentCount + 1;
+                    push(result);
+                    return;
+                }
+                default:
+                    break;
+            }
+        }
+
+        runtimeError("Can only call functions and classes");
+    }
+
+    void VirtualMachine::call(Objects::Closure* closure, uint8_t argumentCount)
+    {
+        if (argumentCount != closure->function->arity) [[unlikely]]
+        {
+            runtimeError(fmt::format(
+                "Expected {} arguments but got {}", closure->function->arity, argumentCount));
+        }
+
+        if (_frameCount == _frames.size()) [[unlikely]]
+        {
+            runtimeError("Stack overflow");
+        }
+
+        CallFrame& frame = _frames[_frameCount++];
+        frame.closure = closure;
+        frame.ip = closure->function->chunk.code.data();
+        frame.slots = _stackTop - argumentCount - 1;
+        frame.discardsResult = false;
+
+#if SAIL_JIT_SUPPORTED
+        Objects::Function& function = *closure->function;
+        if (_jit && function.compiled == nullptr && ++function.callCount >= _jitThreshold)
+        {
+            tierUp(function);
+        }
+        if (function.compiled != nullptr && _compiledDepth < kCompiledDepthMax)
+        {
+            runCompiled(frame);
+        }
+#endif
+    }
+
+    auto VirtualMachine::tailCall(uint8_t argumentCount, bool discardResult) -> bool
+    {
+        Bytecode::Value callee = peek(argumentCount);
+        Objects::Closure* closure = nullptr;
+        if (callee.isObjectType(ObjectType::eClosure))
+        {
+            closure = callee.as<Objects::Closure>();
+        }
+        else if (callee.isObjectType(ObjectType::eBoundMethod))
+        {
+            auto* bound = callee.as<Objects::BoundMethod>();
+            _stackTop[-argumentCount - 1] = bound->receiver;
+            closure = bound->method;
+        }
+        else
+        {
+            callValue(callee, argumentCount);
+            return false;
+        }
+
+        if (argumentCount != closure->function->arity) [[unlikely]]
+        {
+            runtimeError(fmt::format(
+                "Expected {} arguments but got {}", closure->function->arity, argumentCount));
+        }
+
+        // The callee and its arguments slide down over the frame's slots.
+        CallFrame& frame = _frames[_frameCount - 1];
+        closeUpvalues(frame.slots);
+        std::copy(_stackTop - argumentCount - 1, _stackTop, frame.slots);
+        _stackTop = frame.slots + argumentCount + 1;
+        frame.closure = closure;
+        frame.ip = closure->function->chunk.code.data();
+        frame.discardsResult = frame.discardsResult || discardResult;
+
+#if SAIL_JIT_SUPPORTED
+        Objects::Function& function = *closure->function;
+        if (_jit && function.compiled == nullptr && ++function.callCount >= _jitThreshold)
+        {
+            tierUp(function);
+        }
+#endif
+        return true;
+    }
+
+#if SAIL_JIT_SUPPORTED
+    void VirtualMachine::tierUp(Objects::Function& function)
+    {
+        if (function.compiled == nullptr && !function.interpretOnly)
+        {
+            function.interpretOnly = !_jit->compile(function);
+        }
+    }
+
+    void VirtualMachine::runCompiled(CallFrame& frame)
+    {
+        // Tail calls between compiled functions go round here rather than nesting.
+        bool running = true;
+        while (running)
+        {
+            _compiledDepth++;
+            Bytecode::Value* top = frame.closure->function->compiled(this, frame.slots, _stackTop);
+            _compiledDepth--;
+            running = leaveCompiled(frame, top);
+        }
+    }
+
+    auto VirtualMachine::leaveCompiled(CallFrame& frame, Bytecode::Value* top) -> bool
+    {
+        if (top == nullptr) [[unlikely]]
+        {
+            _compiledTailCall = false;
+            std::rethrow_exception(std::exchange(_jitError, nullptr));
+        }
+
+        if (std::exchange(_compiledTailCall, false))
+        {
+            _stackTop = top;
+            Objects::Function& function = *frame.closure->function;
+            return frame.ip == function.chunk.code.data() && function.compiled != nullptr;
+        }
+
+        if (frame.discardsResult) [[unlikely]]
+        {
+            top[-1] = Bytecode::Value();
+        }
+        _frameCount--;
+        _stackTop = _frameCount == 0 ? frame.slots : top;
+        return false;
+    }
+
+    auto VirtualMachine::runCompiledLoop(CallFrame& frame, const uint8_t* loopStart) -> bool
+    {
+        if (_compiledDepth == kCompiledDepthMax)
+        {
+            return false;
+        }
+
+        Objects::Function& function = *frame.closure->function;
+        tierUp(function);
+
+        size_t offset = loopStart - function.chunk.code.data();
+        for (auto [start, entry] : function.loopEntries)
+        {
+            if (start == offset)
+            {
+                _compiledDepth++;
+                Bytecode::Value* top = entry(this, frame.slots, _stackTop);
+                _compiledDepth--;
+                if (leaveCompiled(frame, top))
+                {
+                    runCompiled(frame);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto VirtualMachine::compiledSlowPath(VirtualMachine* machine,
+                                          Bytecode::Value* stackTop,
+                                          const uint8_t* instruction,
+                                          uint32_t opCode) -> Bytecode::Value*
+    {
+        machine->_stackTop = stackTop;
+        // Runtime errors report the line of the instruction the frame points just past.
+        machine->_frames[machine->_frameCount - 1].ip = const_cast<uint8_t*>(instruction + 1);
+        try
+        {
+            machine->executeSlowPath(static_cast<OpCode>(opCode), instruction + 1);
+        }
+        catch (...)
+        {
+            machine->_jitError = std::current_exception();
+            return nullptr;
+        }
+        return machine->_stackTop;
+    }
+
+    void VirtualMachine::executeSlowPath(OpCode opCode, const uint8_t* operands)
+    {
+        CallFrame& frame = _frames[_frameCount - 1];
+        auto readShort = [&]() -> uint16_t
+        { return static_cast<uint16_t>((operands[0] << 8U) | operands[1]); };
+        auto readConstant = [&]() -> Bytecode::Value&
+        { return frame.closure->function->chunk.constants[readShort()]; };
+        auto readString = [&]() -> Objects::String*
+        { return readConstant().as<Objects::String>(); };
+
+        switch (opCode)
+        {
+            case OpCode::eGetGlobal:
+            {
+                Global& global = _globals[readShort()];
+                if (!global.defined)
+                {
+                    runtimeError(
+                        fmt::format("Attempted to get undefined variable '{}'", global.name));
+                }
+                push(global.value);
+                break;
+            }
+            case OpCode::eDefineGlobal:
+            {
+                Global& global = _globals[readShort()];
+                global.value = pop();
+                global.defined = true;
+                break;
+            }
+            case OpCode::eSetGlobal:
+            {
+                Global& global = _globals[readShort()];
+                if (!global.defined)
+                {
+                    runtimeError(
+                        fmt::format("Attempted to assign undefined variable '{}'", global.name));
+                }
+                global.value = peek(0);
+                break;
+            }
+            case OpCode::eGetUpvalue:
+                push(*frame.closure->upvalues[operands[0]]->location);
+                break;
+            case OpCode::eSetUpvalue:
+            {
+                Objects::Upvalue* upvalue = frame.closure->upvalues[operands[0]];
+                *upvalue->location = peek(0);
+                _heap.writeBarrier(upvalue, peek(0));
+                break;
+            }
+            case OpCode::eGetProperty:
+                getProperty(readString());
+                break;
+            case OpCode::eSetProperty:
+                setProperty(readString());
+                break;
+            case OpCode::eGetSuper:
+                getSuper(readString());
+                break;
+            case OpCode::eEqual:
+            {
+                Bytecode::Value right = pop();
+                _stackTop[-1] = Bytecode::Value(_stackTop[-1] == right);
+                break;
+            }
+            case OpCode::eNotEqual:
+            {
+                Bytecode::Value right = pop();
+                _stackTop[-1] = Bytecode::Value(!(_stackTop[-1] == right));
+                break;
+            }
+            case OpCode::eNot:
+                _stackTop[-1] = Bytecode::Value(!_stackTop[-1].isTruthy());
+                break;
+            case OpCode::eNegate:
+            {
+                std::optional<double> number = peek(0).toNumber();
+                if (!number.has_value())
+                {
+                    runtimeError("Cannot negate a non-number");
+                }
+                _stackTop[-1] = Bytecode::Value(-*number);
+                break;
+            }
+            case OpCode::eAdd:
+                if (peek(0).isObjectType(ObjectType::eString)
+                    && peek(1).isObjectType(ObjectType::eString))
+                {
+                    concatenate();
+                    break;
+                }
+                arithmetic(opCode);
+                break;
+            case OpCode::eIncrementLocal:
+            {
+                Bytecode::Value& local = frame.slots[operands[0]];
+                push(local);
+                push(frame.closure->function->chunk.constants[static_cast<uint16_t>(
+                    (operands[1] << 8U) | operands[2])]);
+                arithmetic(OpCode::eAdd);
+                local = pop();
+                break;
+            }
+            case OpCode::eCall:
+            {
+                // The callee returns here before the compiled caller carries on. Interpreted
+                // callees get their own dispatch loop, stopping once their frame has returned.
+                size_t depth = _frameCount;
+                uint8_t argumentCount = operands[0];
+                callValue(peek(argumentCount), argumentCount);
+                if (_frameCount > depth)
+                {
+                    run(depth);
+                }
+                break;
+            }
+            case OpCode::eTailCall:
+            {
+                // Compiled code exits after this, leaving the frame to whatever runs next in it:
+                // the callee, or the dispatch loop from the instruction after this one.
+                size_t depth = _frameCount;
+                if (!tailCall(operands[0], operands[1] != 0))
+                {
+                    if (_frameCount > depth)
+                    {
+                        run(depth);
+                    }
+                    frame.ip = const_cast<uint8_t*>(operands + 2);
+                }
+                _compiledTailCall = true;
+                break;
+            }
+            case OpCode::eClosure:
+                makeClosure(readConstant().as<Objects::Function>(), operands + 2, frame);
+                break;
+            case OpCode::eCloseUpvalue:
+                closeUpvalues(_stackTop - 1);
+                _stackTop--;
+                break;
+            case OpCode::eReturn:
+                // Only closes the frame's upvalues. Compiled code returns by itself.
+                closeUpvalues(frame.slots);
+                break;
+            case OpCode::eClass:
+                push(allocate<Objects::Class>(readString()->value));
+                break;
+            case OpCode::eInherit:
+                inherit();
+                break;
+            case OpCode::eMethod:
+                defineMethod(readString());
+                break;
+            default:
+                arithmetic(opCode);
+                break;
+        }
+    }
+
+    void VirtualMachine::arithmetic(OpCode opCode)
+    {
+        std::optional<double> left = peek(1).toNumber();
+        std::optional<double> right = peek(0).toNumber();
+        if (!left.has_value() || !right.has_value())
+        {
+            runtimeError("Cannot perform arithmetic on non-numbers");
+        }
+
+        Bytecode::Value result;
+        switch (opCode)
+        {
+            case OpCode::eGreater:
+                result = Bytecode::Value(*left > *right);
+                break;
+            case OpCode::eGreaterEqual:
+                result = Bytecode::Value(*left >= *right);
+                break;
+            case OpCode::eLess:
+                result = Bytecode::Value(*left < *right);
+                break;
+            case OpCode::eLessEqual:
+                result = Bytecode::Value(*left <= *right);
+                break;
+            case OpCode::eAdd:
+                result = Bytecode::Value(*left + *right);
+                break;
+            case OpCode::eSubtract:
+                result = Bytecode::Value(*left - *right);
+                break;
+            case OpCode::eMultiply:
+                result = Bytecode::Value(*left * *right);
+                break;
+            default:
+                result = Bytecode::Value(*left / *right);
+                break;
+        }
+        _stackTop[-2] = result;
+        _stackTop--;
+    }
+#endif
+
+    auto VirtualMachine::captureUpvalue(Bytecode::Value* local) -> Objects::Upvalue*
+    {
+        Objects::Upvalue* previous = nullptr;
+        Objects::Upvalue* upvalue = _openUpvalues;
+        while (upvalue != nullptr && upvalue->location > local)
+        {
+            previous = upvalue;
+            upvalue = upvalue->nextOpen;
+        }
+
+        if (upvalue != nullptr && upvalue->location == local)
+        {
+            return upvalue;
+        }
+
+        auto* created = allocate<Objects::Upvalue>(local);
+        created->nextOpen = upvalue;
+        if (previous == nullptr)
+        {
+            _openUpvalues = created;
+        }
+        else
+        {
+            previous->nextOpen = created;
+        }
+
+        return created;
+    }
+
+    void VirtualMachine::closeUpvalues(const Bytecode::Value* last)
+    {
+        while (_openUpvalues != nullptr && _openUpvalues->location >= last)
+        {
+            Objects::Upvalue* upvalue = _openUpvalues;
+            upvalue->closed = *upvalue->location;
+            upvalue->location = &upvalue->closed;
+            _heap.writeBarrier(upvalue, upvalue->closed);
+            _openUpvalues = upvalue->nextOpen;
+        }
+    }
+
+    void VirtualMachine::concatenate()
+    {
+        auto* right = peek(0).as<Objects::String>();
+        auto* left = peek(1).as<Objects::String>();
+        auto* result = intern(left->value + right->value);
+        _stackTop -= 2;
+        push(result);
+    }
+
+    void VirtualMachine::getProperty(Objects::String* name)
+    {
+        if (!peek(0).isObjectType(ObjectType::eInstance)) [[unlikely]]
+        {
+            runtimeError("Only instances have properties");
+        }
+
+        auto* instance = peek(0).as<Objects::Instance>();
+        auto it = instance->fields.find(name);
+        if (it != instance->fields.end())
+        {
+            _stackTop[-1] = it->second;
+            return;
+        }
+
+        Objects::Closure* method = instance->klass->findMethod(name);
+        if (method == nullptr) [[unlikely]]
+        {
+            runtimeError(fmt::format("Undefined property '{}'.", name->value));
+        }
+        _stackTop[-1] = allocate<Objects::BoundMethod>(instance, method);
+    }
+
+    void VirtualMachine::setProperty(Objects::String* name)
+    {
+        if (!peek(1).isObjectType(ObjectType::eInstance)) [[unlikely]]
+        {
+            runtimeError("Only instances have fields");
+        }
+
+        auto* instance = peek(1).as<Objects::Instance>();
+        instance->fields[name] = peek(0);
+        // The key is a heap string too, and may be younger than the instance.
+        _heap.writeBarrier(instance, name);
+        _heap.writeBarrier(instance, peek(0));
+        Bytecode::Value value = pop();
+        _stackTop[-1] = value;
+    }
+
+    void VirtualMachine::getSuper(Objects::String* name)
+    {
+        auto* superclass = peek(0).as<Objects::Class>();
+        Objects::Closure* method = superclass->findMethod(name);
+        if (method == nullptr) [[unlikely]]
+        {
+            runtimeError(fmt::format("Undefined property '{}'.", name->value));
+        }
+        _stackTop[-2] = allocate<Objects::BoundMethod>(peek(1), method);
+        _stackTop--;
+    }
+
+    void VirtualMachine::makeClosure(Objects::Function* function,
+                                     const uint8_t* upvalues,
+                                     CallFrame& frame)
+    {
+        auto* closure = allocate<Objects::Closure>(function);
+        push(closure);
+        for (auto& upvalue : closure->upvalues)
+        {
+            uint8_t isLocal = *upvalues++;
+            uint8_t index = *upvalues++;
+            upvalue = isLocal != 0U ? captureUpvalue(frame.slots + index)
+                                    : frame.closure->upvalues[index];
+            // Capturing can allocate, which may already have promoted the closure.
+            _heap.writeBarrier(closure, upvalue);
+        }
+    }
+
+    void VirtualMachine::inherit()
+    {
+        if (!peek(1).isObjectType(ObjectType::eClass)) [[unlikely]]
+        {
+            runtimeError("Superclass must be a class");
+        }
+        auto* subclass = pop().as<Objects::Class>();
+        subclass->superclass = peek(0).as<Objects::Class>();
+        _heap.writeBarrier(subclass, subclass->superclass);
+    }
+
+    void VirtualMachine::defineMethod(Objects::String* name)
+    {
+        auto* klass = peek(1).as<Objects::Class>();
+        auto* method = pop().as<Objects::Closure>();
+        klass->methods[name] = method;
+        _heap.writeBarrier(klass, name);
+        _heap.writeBarrier(klass, method);
+    }
+
+    void VirtualMachine::runtimeError(const std::string& message)
+    {
+        size_t line = 0;
+        if (_frameCount > 0)
+        {
+            CallFrame& frame = _frames[_frameCount - 1];
+            Bytecode::Chunk& chunk = frame.closure->function->chunk;
+            size_t offset = frame.ip - chunk.code.data();
+            line = chunk.lines[offset > 0 ? offset - 1 : 0];
+        }
+
+        throw RuntimeError(line, message);
+    }
+
+    void VirtualMachine::resetStack()
+    {
+        _stackTop = _stack.get();
+        _frameCount = 0;
+        _openUpvalues = nullptr;
+#if SAIL_JIT_SUPPORTED
+        _compiledDepth = 0;
+        _compiledTailCall = false;
+#endif
+    }
+}  // namespace sail
@@ -0,0 +1,55 @@
+#include <limits>
+
+#include "Bytecode/Value.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "Memory/Heap.h"
+#include "Objects/Objects.h"
+
+using sail::Bytecode::Value;
+using sail::Bytecode::ValueType;
+
+TEST_CASE("Bytecode values round-trip through their encoding", "[Value]")
+{
+    CHECK(Value().isNull());
+    CHECK(Value().type() == ValueType::eNull);
+
+    CHECK(Value(true).isBool());
+    CHECK(Value(true).asBool());
+    CHECK_FALSE(Value(false).asBool());
+
+    CHECK(Value(1.5).isNumber());
+    CHECK(Value(1.5).asNumber() == 1.5);
+    CHECK(Value(-0.0).isNumber());
+    CHECK(Value(std::numeric_limits<double>::infinity()).isNumber());
+    CHECK(Value(std::numeric_limits<double>::quiet_NaN()).isNumber());
+
+    sail::Objects::String string {"text"};
+    Value object {static_cast<sail::Object*>(&string)};
+    CHECK(object.isObject());
+    CHECK(object.isObjectType(sail::ObjectType::eString));
+    CHECK(object.as<sail::Objects::String>() == &string);
+}
+
+TEST_CASE("Bytecode values compare like sail::Value", "[Value]")
+{
+    CHECK(Value(2.0) == Value(2.0));
+    CHECK_FALSE(Value(1.0) == Value(true));
+    CHECK_FALSE(Value() == Value(false));
+    CHECK_FALSE(Value(std::numeric_limits<double>::quiet_NaN())
+                == Value(std::numeric_limits<double>::quiet_NaN()));
+
+    sail::Heap heap;
+    sail::Objects::String* same = heap.intern("same");
+    CHECK(heap.intern("same") == same);
+    CHECK(Value(static_cast<sail::Object*>(same))
+          == Value(static_cast<sail::Object*>(heap.intern("same"))));
+    CHECK_FALSE(Value(static_cast<sail::Object*>(same))
+                == Value(static_cast<sail::Object*>(heap.intern("other"))));
+
+    CHECK(Value(true).toNumber() == 1.0);
+    CHECK_FALSE(Value().toNumber().has_value());
+    CHECK_FALSE(Value().isTruthy());
+    CHECK_FALSE(Value(0.0).isTruthy());
+}
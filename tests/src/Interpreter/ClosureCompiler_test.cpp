@@ -0,0 +1,274 @@
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Interpreter/ClosureCompiler.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "Errors/RuntimeError.h"
+#include "Interpreter/Interpreter.h"
+#include "Parser/Parser.h"
+#include "Resolver/Resolver.h"
+#include "Scanner/Scanner.h"
+
+namespace
+{
+    auto parse(const std::string& source, sail::Selectors& selectors)
+        -> std::vector<std::shared_ptr<sail::Statement>>
+    {
+        using namespace sail;
+
+        std::vector<Token> tokens;
+        Scanner scanner {source, tokens};
+        scanner.scanTokens();
+
+        Parser parser {tokens};
+        std::vector<std::shared_ptr<Statement>> statements = parser.parse();
+
+        Resolver resolver {selectors};
+        resolver.resolve(statements);
+        return statements;
+    }
+
+    auto run(std::vector<std::shared_ptr<sail::Statement>>& statements,
+             sail::Selectors& selectors,
+             bool compile,
+             size_t maxCallDepth = 1024) -> std::string
+    {
+        using namespace sail;
+
+        std::ostringstream output;
+        std::streambuf* previous = std::cout.rdbuf(output.rdbuf());
+
+        Interpreter interpreter {selectors, maxCallDepth};
+        try
+        {
+            if (compile)
+            {
+                ClosureCompiler compiler;
+                interpreter.interpret(compiler.compile(statements));
+            }
+            else
+            {
+                interpreter.interpret(statements);
+            }
+        }
+        catch (const RuntimeError&)
+        {
+            output << "error\n";
+        }
+
+        std::cout.rdbuf(previous);
+        return output.str();
+    }
+
+    auto run(const std::string& source, bool compile, size_t maxCallDepth = 1024) -> std::string
+    {
+        sail::Selectors selectors;
+        std::vector<std::shared_ptr<sail::Statement>> statements = parse(source, selectors);
+        return run(statements, selectors, compile, maxCallDepth);
+    }
+}  // namespace
+
+TEST_CASE("Compiled closures behave like the tree-walker", "[ClosureCompiler]")
+{
+    const std::string sources[] = {
+        "print(1 + 2 * 3); print(\"a\" + \"b\"); print(true + 1); print(1 == 1 && !false);",
+        "fn fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); } print(fib(15));",
+        R"(fn counter() { let i = 0; fn count() { i = i + 1; return i; } return count; }
+           let c = counter(); c(); print(c());)",
+        R"(class A { init(x) { this.x = x; } get() { return this.x; } }
+           class B < A { init(x) { super.init(x * 2); } get() { return super.get() + 1; } }
+           print(B(5).get());)",
+        "let i = 0; while (i < 3) { print(i); i = i + 1; } print(i - \"x\");",
+    };
+
+    for (const std::string& source : sources)
+    {
+        REQUIRE(run(source, true) == run(source, false));
+    }
+}
+
+TEST_CASE("Calls in tail position run in constant stack space", "[ClosureCompiler]")
+{
+    const std::string sources[] = {
+        "fn count(n) { if (n == 0) return n; return count(n - 1); } print(count(200000));",
+        R"(fn isEven(n) { if (n == 0) return true; return isOdd(n - 1); }
+           fn isOdd(n) { if (n == 0) return false; return isEven(n - 1); }
+           print(isEven(100001));)",
+        "fn loop(i) { if (i < 100000) { loop(i + 1); } else { print(i); } } print(loop(0));",
+        R"(class A { init() { this.n = 0; }
+                     step(k) { if (k == 0) return this.n; this.n = this.n + 1;
+                               return this.step(k - 1); } }
+           print(A().step(100000));)",
+    };
+    const std::string expected[] = {"0\n", "0\n", "100000\nnull\n", "100000\n"};
+
+    for (size_t i = 0; i < std::size(sources); i++)
+    {
+        REQUIRE(run(sources[i], false) == expected[i]);
+        REQUIRE(run(sources[i], true) == expected[i]);
+    }
+}
+
+TEST_CASE("Calls nested too deeply raise an error", "[ClosureCompiler]")
+{
+    const std::string source =
+        "fn d(n) { if (n == 0) return 0; return 1 + d(n - 1); } print(d(99)); print(d(100));";
+
+    REQUIRE(run(source, false, 100) == "99\nerror\n");
+    REQUIRE(run(source, true, 100) == "99\nerror\n");
+}
+
+TEST_CASE("Calls stop before the native stack runs out", "[ClosureCompiler]")
+{
+    // Far deeper than any thread's stack holds, so only the native stack check can stop it.
+    const std::string source =
+        "fn d(n) { if (n == 0) return 0; return 1 + d(n - 1); } print(d(10000000));";
+
+    REQUIRE(run(source, false, 100000000) == "error\n");
+    REQUIRE(run(source, true, 100000000) == "error\n");
+}
+
+TEST_CASE("Classes are freed along with the caches in their methods", "[ClosureCompiler]")
+{
+    const std::string source = R"(
+        class A { init() { this.x = 1; } get() { return this.x; } }
+        let a = A(); print(a.get());
+    )";
+
+    for (bool compile : {false, true})
+    {
+        sail::Selectors selectors;
+        std::weak_ptr<sail::Statements::Function> method;
+        {
+            std::vector<std::shared_ptr<sail::Statement>> statements = parse(source, selectors);
+            method = static_cast<sail::Statements::Class&>(*statements[0]).methods[1];
+            REQUIRE(run(statements, selectors, compile) == "1\n");
+        }
+        // The method's syntax tree holds the caches of its property accesses.
+        REQUIRE(method.expired());
+    }
+}
+
+TEST_CASE("Sites naming a method before its class is declared find it", "[ClosureCompiler]")
+{
+    const std::string source = R"(
+        fn call(o) { return o.m(); }
+        class A { m() { return "A"; } }
+        class B < A { m() { return super.m() + "B"; } }
+        print(call(A())); print(call(B()));
+    )";
+
+    REQUIRE(run(source, false) == "A\nAB\n");
+    REQUIRE(run(source, true) == "A\nAB\n");
+}
+
+TEST_CASE("Invoked methods resolve like other property accesses", "[ClosureCompiler]")
+{
+    const std::string source = R"(
+        class A { name() { return "A"; } greet() { return "hi " + this.name(); } }
+        class B < A { name() { return "B"; } }
+        fn shadow() { return "field"; }
+        let a = A(); let b = B();
+        print(a.greet()); print(b.greet());
+        b.name = shadow;
+        print(b.name()); print(b.greet()); print(A().greet());
+        let bound = a.name; print(bound());
+    )";
+    // A field shadows the method of the same name, and an override replaces the inherited one.
+    const std::string expected = "hi A\nhi B\nfield\nhi field\nhi A\nA\n";
+
+    REQUIRE(run(source, false) == expected);
+    REQUIRE(run(source, true) == expected);
+}
+
+TEST_CASE("Binary sites warmed with numbers still handle other operands", "[ClosureCompiler]")
+{
+    auto interpret = [](const std::string& warmUp, sail::Expressions::OperandTypes& recorded)
+    {
+        const std::string source = R"(
+            fn add(a, b) { return a + b; }
+            fn less(a, b) { return a < b; }
+            )" + warmUp + R"(
+            print(add("a", "b")); print(add(2, 3));
+            print(less("a", "b"));
+        )";
+        sail::Selectors selectors;
+        std::vector<std::shared_ptr<sail::Statement>> statements = parse(source, selectors);
+
+        std::ostringstream output;
+        std::streambuf* previous = std::cout.rdbuf(output.rdbuf());
+        sail::Interpreter interpreter {selectors};
+        try
+        {
+            interpreter.interpret(statements);
+        }
+        catch (const sail::RuntimeError& error)
+        {
+            output << error.what() << "\n";
+        }
+        std::cout.rdbuf(previous);
+
+        auto& add = dynamic_cast<sail::Statements::Function&>(*statements[0]);
+        auto& sum = dynamic_cast<sail::Statements::Return&>(*add.body[0]).value;
+        recorded = dynamic_cast<sail::Expressions::Binary&>(*sum).operandTypes;
+        return output.str();
+    };
+
+    sail::Expressions::OperandTypes warmTypes {};
+    sail::Expressions::OperandTypes coldTypes {};
+    const std::string warm = interpret(
+        "for (let i = 0; i < 100; i = i + 1) { add(i, 1); less(i, 1); }", warmTypes);
+    const std::string cold = interpret("", coldTypes);
+
+    // Strings concatenate and comparisons raise the same error as at sites without feedback.
+    REQUIRE(warm == cold);
+    REQUIRE(warm.starts_with("ab\n5\n"));
+    REQUIRE(warm.find("Cannot perform arithmetic on non-numbers") != std::string::npos);
+    REQUIRE(warmTypes == sail::Expressions::OperandTypes::eMixed);
+}
+
+TEST_CASE("Locals resolve to the innermost declaration in scope", "[ClosureCompiler]")
+{
+    const std::string source = R"(
+        let a = "global";
+        fn f(x) {
+            let a = "outer";
+            { let a = "inner"; let b = x; print(a + b); }
+            print(a);
+            { let c = "c"; print(c + a); }
+            return a;
+        }
+        print(f("!")); print(a);
+        class P { init(v) { this.v = v; } show(s) { let t = s; { let v = this.v; print(t + v); } } }
+        P("v").show("t");
+    )";
+    const std::string expected = "inner!\nouter\ncouter\nouter\nglobal\ntv\n";
+
+    REQUIRE(run(source, false) == expected);
+    REQUIRE(run(source, true) == expected);
+}
+
+TEST_CASE("Arguments pass by value even when calls nest", "[ClosureCompiler]")
+{
+    const std::string source = R"(
+        fn pair(a, b) { return a + "," + b; }
+        fn id(x) { return x; }
+        fn bump(n) { n = n + 1; return n; }
+        fn keep(v) { fn get() { return v; } return get; }
+        let s = "s"; let n = 1;
+        print(pair(id("a"), pair(id("b"), id("c"))));
+        print(bump(n)); print(n);
+        print(pair(s, s)); print(s);
+        let first = keep("one"); let second = keep("two"); print(first() + second());
+    )";
+    // Each call gets its own arguments, and the caller's variables keep their values.
+    const std::string expected = "a,b,c\n2\n1\ns,s\ns\nonetwo\n";
+
+    REQUIRE(run(source, false) == expected);
+    REQUIRE(run(source, true) == expected);
+}
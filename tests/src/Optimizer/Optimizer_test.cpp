@@ -0,0 +1,97 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Optimizer/Optimizer.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "Expressions/Expressions.h"
+#include "Parser/Parser.h"
+#include "Resolver/Resolver.h"
+#include "Scanner/Scanner.h"
+#include "Statements/Statements.h"
+
+namespace
+{
+    auto optimize(const std::string& source) -> std::vector<std::shared_ptr<sail::Statement>>
+    {
+        using namespace sail;
+
+        std::vector<Token> tokens;
+        Scanner scanner {source, tokens};
+        scanner.scanTokens();
+
+        Parser parser {tokens};
+        std::vector<std::shared_ptr<Statement>> statements = parser.parse();
+
+        Selectors selectors;
+        Resolver resolver {selectors};
+        resolver.resolve(statements);
+
+        Optimizer optimizer;
+        optimizer.optimize(statements);
+        return statements;
+    }
+
+    auto initializer(const std::shared_ptr<sail::Statement>& statement)
+        -> std::shared_ptr<sail::Expression>
+    {
+        return dynamic_cast<sail::Statements::Variable&>(*statement).initializer;
+    }
+
+    auto literal(const std::shared_ptr<sail::Statement>& statement) -> sail::LiteralType
+    {
+        auto* literal = dynamic_cast<sail::Expressions::Literal*>(initializer(statement).get());
+        REQUIRE(literal != nullptr);
+        return literal->literal;
+    }
+}  // namespace
+
+TEST_CASE("Constant subtrees are folded into literals", "[Optimizer]")
+{
+    auto statements = optimize(
+        "let a = (1 + 2) * 3; let b = \"s\" + \"ail\"; let c = !(1 < 2); let d = true || x;");
+
+    REQUIRE(literal(statements[0]) == sail::LiteralType {9.0});
+    REQUIRE(literal(statements[1]) == sail::LiteralType {std::string("sail")});
+    REQUIRE(literal(statements[2]) == sail::LiteralType {false});
+    REQUIRE(literal(statements[3]) == sail::LiteralType {true});
+}
+
+TEST_CASE("Expressions that raise errors are not folded", "[Optimizer]")
+{
+    auto statements = optimize("let a = \"s\" - 1;");
+
+    REQUIRE(dynamic_cast<sail::Expressions::Binary*>(initializer(statements[0]).get())
+            != nullptr);
+}
+
+TEST_CASE("Identities are simplified only for numeric operands", "[Optimizer]")
+{
+    auto statements = optimize("let a = 1; let b = (a - 2) * 1; let c = a * 1; let d = (a);");
+
+    auto* difference = dynamic_cast<sail::Expressions::Binary*>(initializer(statements[1]).get());
+    REQUIRE(difference != nullptr);
+    REQUIRE(difference->op.type == sail::TokenType::eMinus);
+
+    auto* product = dynamic_cast<sail::Expressions::Binary*>(initializer(statements[2]).get());
+    REQUIRE(product != nullptr);
+    REQUIRE(product->op.type == sail::TokenType::eStar);
+
+    REQUIRE(dynamic_cast<sail::Expressions::Variable*>(initializer(statements[3]).get())
+            != nullptr);
+}
+
+TEST_CASE("Code that cannot run or has no effect is removed", "[Optimizer]")
+{
+    auto statements = optimize(
+        "fn f(x) { let unused = 1; let called = f(0); if (false) f(1); while (false) f(2);"
+        "  if (true) f(3); else f(4); return x; f(5); }");
+    auto& body = dynamic_cast<sail::Statements::Function&>(*statements[0]).body;
+
+    REQUIRE(body.size() == 3);
+    REQUIRE(dynamic_cast<sail::Statements::Variable*>(body[0].get()) != nullptr);
+    REQUIRE(dynamic_cast<sail::Statements::Expression*>(body[1].get()) != nullptr);
+    REQUIRE(dynamic_cast<sail::Statements::Return*>(body[2].get()) != nullptr);
+}
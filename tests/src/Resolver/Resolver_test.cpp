@@ -0,0 +1,109 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Resolver/Resolver.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "Parser/Parser.h"
+#include "Scanner/Scanner.h"
+#include "Statements/Statements.h"
+
+namespace
+{
+    auto resolve(const std::string& source, sail::Selectors& selectors)
+        -> std::vector<std::shared_ptr<sail::Statement>>
+    {
+        using namespace sail;
+
+        std::vector<Token> tokens;
+        Scanner scanner {source, tokens};
+        scanner.scanTokens();
+
+        Parser parser {tokens};
+        std::vector<std::shared_ptr<Statement>> statements = parser.parse();
+
+        Resolver resolver {selectors};
+        resolver.resolve(statements);
+        return statements;
+    }
+
+    auto resolve(const std::string& source) -> std::vector<std::shared_ptr<sail::Statement>>
+    {
+        sail::Selectors selectors;
+        return resolve(source, selectors);
+    }
+
+    auto function(const std::shared_ptr<sail::Statement>& statement) -> sail::Statements::Function&
+    {
+        return dynamic_cast<sail::Statements::Function&>(*statement);
+    }
+}  // namespace
+
+TEST_CASE("Functions without closures capture nothing", "[Resolver]")
+{
+    auto statements =
+        resolve("fn add(a, b) { let sum = a + b; { let twice = sum * 2; } return sum; }");
+    sail::Statements::Function& add = function(statements[0]);
+
+    REQUIRE(add.captures.empty());
+    REQUIRE(add.slotCount == 4);
+}
+
+TEST_CASE("Closures capture only the variables they use", "[Resolver]")
+{
+    auto statements = resolve(
+        "fn outer() { let a = 1; let b = 2; let c = 3;"
+        "  fn middle() { fn inner() { return c + a; } return inner; } return middle; }");
+    sail::Statements::Function& outer = function(statements[0]);
+    sail::Statements::Function& middle = function(outer.body[3]);
+    sail::Statements::Function& inner = function(middle.body[0]);
+
+    using sail::Statements::Capture;
+    REQUIRE(outer.captures.empty());
+    REQUIRE(middle.captures == std::vector<Capture> {{true, 2}, {true, 0}});
+    REQUIRE(inner.captures == std::vector<Capture> {{false, 0}, {false, 1}});
+}
+
+TEST_CASE("Calls a function ends with are tail calls", "[Resolver]")
+{
+    auto statements = resolve(
+        "fn f(n) { if (n) return f(n - 1); g(n); while (n) { return g(n); } return 1 + g(n); }"
+        "fn g(n) { if (n) { g(n - 1); } else g(n); }"
+        "class A { init() { this.f(); } }");
+    sail::Statements::Function& f = function(statements[0]);
+    sail::Statements::Function& g = function(statements[1]);
+    auto& initializer = *dynamic_cast<sail::Statements::Class&>(*statements[2]).methods[0];
+
+    auto& ifReturn = dynamic_cast<sail::Statements::Return&>(
+        *dynamic_cast<sail::Statements::If&>(*f.body[0]).thenBranch);
+    auto& loopBody = dynamic_cast<sail::Statements::Block&>(
+        *dynamic_cast<sail::Statements::While&>(*f.body[2]).body);
+    REQUIRE(ifReturn.tailCall != nullptr);
+    REQUIRE(dynamic_cast<sail::Statements::Expression&>(*f.body[1]).tailCall == nullptr);
+    REQUIRE(dynamic_cast<sail::Statements::Return&>(*loopBody.statements[0]).tailCall != nullptr);
+    REQUIRE(dynamic_cast<sail::Statements::Return&>(*f.body[3]).tailCall == nullptr);
+
+    auto& branches = dynamic_cast<sail::Statements::If&>(*g.body[0]);
+    auto& thenBlock = dynamic_cast<sail::Statements::Block&>(*branches.thenBranch);
+    REQUIRE(dynamic_cast<sail::Statements::Expression&>(*thenBlock.statements[0]).tailCall !=
+            nullptr);
+    REQUIRE(dynamic_cast<sail::Statements::Expression&>(*branches.elseBranch).tailCall != nullptr);
+
+    REQUIRE(dynamic_cast<sail::Statements::Expression&>(*initializer.body[0]).tailCall == nullptr);
+}
+
+TEST_CASE("Only method names are numbered", "[Resolver]")
+{
+    sail::Selectors selectors;
+    resolve("class A { get() { return this.x; } } let a = A(); a.y = a.get();", selectors);
+
+    REQUIRE(selectors.find("init") == sail::Selectors::kInitializer);
+    REQUIRE(selectors.find("get") == sail::Selectors::kInitializer + 1);
+    REQUIRE(selectors.find("x") == sail::Selectors::kNone);
+    REQUIRE(selectors.find("y") == sail::Selectors::kNone);
+
+    sail::Selectors other;
+    REQUIRE(other.find("get") == sail::Selectors::kNone);
+}
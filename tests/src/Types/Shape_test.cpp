@@ -0,0 +1,136 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Types/ShapeType.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "Expressions/InlineCache.h"
+#include "Types/Types.h"
+
+namespace
+{
+    auto identifier(const std::string& lexeme) -> sail::Token
+    {
+        return {sail::TokenType::eIdentifier, lexeme, "", 1};
+    }
+
+    auto makeClass() -> std::shared_ptr<sail::Types::Class>
+    {
+        const std::vector<std::shared_ptr<sail::Types::Function>> methods;
+        return std::make_shared<sail::Types::Class>("A", nullptr, methods);
+    }
+
+    void store(sail::Types::Instance& instance, const std::string& field, double value)
+    {
+        instance.set(instance.resolveSet(identifier(field)), value);
+    }
+
+    auto lookup(sail::Expressions::PropertyCache& cache, sail::Types::Instance& instance)
+        -> const sail::Expressions::PropertyCacheEntry&
+    {
+        const sail::Expressions::PropertyCacheEntry* entry = cache.find(instance.shape());
+        if (entry == nullptr)
+        {
+            entry = &cache.add(instance.resolveGet(identifier("x"), sail::Selectors::kNone));
+        }
+        return *entry;
+    }
+}  // namespace
+
+TEST_CASE("Shapes assign slots in insertion order", "[Shape]")
+{
+    sail::Types::Shape root;
+    sail::Types::Shape* xy = root.withField("x")->withField("y");
+
+    REQUIRE(xy->fieldCount() == 2);
+    REQUIRE(xy->slotOf("x") == 0);
+    REQUIRE(xy->slotOf("y") == 1);
+    REQUIRE_FALSE(xy->slotOf("z").has_value());
+    REQUIRE_FALSE(root.slotOf("x").has_value());
+}
+
+TEST_CASE("Shapes share transitions", "[Shape]")
+{
+    sail::Types::Shape root;
+
+    REQUIRE(root.withField("x")->withField("y") == root.withField("x")->withField("y"));
+    REQUIRE(root.withField("x")->withField("y") != root.withField("y")->withField("x"));
+}
+
+TEST_CASE("Property caches keep one entry per shape up to their limit", "[Shape]")
+{
+    using sail::Expressions::PropertyCache;
+
+    // A different first field gives each instance a shape of its own, with x in the second slot.
+    std::shared_ptr<sail::Types::Class> klass = makeClass();
+    std::vector<std::shared_ptr<sail::Types::Instance>> instances;
+    for (const char* first : {"a", "b", "c", "d", "e"})
+    {
+        auto instance = std::make_shared<sail::Types::Instance>(klass);
+        store(*instance, first, 0);
+        store(*instance, "x", static_cast<double>(instances.size()));
+        instances.push_back(instance);
+    }
+
+    PropertyCache cache;
+    for (size_t i = 0; i < PropertyCache::kEntries; i++)
+    {
+        REQUIRE(cache.find(instances[i]->shape()) == nullptr);
+        const sail::Value expected = static_cast<double>(i);
+        REQUIRE(instances[i]->get(lookup(cache, *instances[i])) == expected);
+        REQUIRE(cache.count == i + 1);
+    }
+    for (size_t i = 0; i < PropertyCache::kEntries; i++)
+    {
+        REQUIRE(cache.find(instances[i]->shape()) != nullptr);
+    }
+
+    // One shape more replaces the oldest entry.
+    sail::Types::Instance& extra = *instances[PropertyCache::kEntries];
+    const sail::Value expected = static_cast<double>(PropertyCache::kEntries);
+    REQUIRE(extra.get(lookup(cache, extra)) == expected);
+    REQUIRE(cache.count == PropertyCache::kEntries);
+    REQUIRE(cache.find(extra.shape()) != nullptr);
+    REQUIRE(cache.find(instances[0]->shape()) == nullptr);
+    REQUIRE(cache.find(instances[1]->shape()) != nullptr);
+}
+
+TEST_CASE("Property caches miss once an instance changes shape", "[Shape]")
+{
+    auto instance = std::make_shared<sail::Types::Instance>(makeClass());
+    store(*instance, "x", 1);
+
+    sail::Expressions::PropertyCache cache;
+    REQUIRE(instance->get(lookup(cache, *instance)) == sail::Value(1.0));
+    const sail::Types::Shape* cached = instance->shape();
+
+    // Adding a field moves the instance to another shape, which the cache has not seen.
+    store(*instance, "y", 2);
+    REQUIRE(instance->shape() != cached);
+    REQUIRE(cache.find(instance->shape()) == nullptr);
+    REQUIRE(instance->get(lookup(cache, *instance)) == sail::Value(1.0));
+    REQUIRE(cache.count == 2);
+
+    // Storing to an existing field keeps the shape, and the cached entry sees the new value.
+    store(*instance, "x", 3);
+    REQUIRE(cache.find(instance->shape()) != nullptr);
+    REQUIRE(instance->get(lookup(cache, *instance)) == sail::Value(3.0));
+}
+
+TEST_CASE("Property caches never match the shapes of freed classes", "[Shape]")
+{
+    sail::Expressions::PropertyCache cache;
+    const sail::Types::Shape* shape = nullptr;
+    {
+        auto instance = std::make_shared<sail::Types::Instance>(makeClass());
+        store(*instance, "x", 1);
+        lookup(cache, *instance);
+        shape = instance->shape();
+        REQUIRE(cache.find(shape) != nullptr);
+    }
+
+    // The shape's address may now belong to another class's shape.
+    REQUIRE(cache.find(shape) == nullptr);
+}
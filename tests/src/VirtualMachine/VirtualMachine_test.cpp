@@ -0,0 +1,272 @@
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "VirtualMachine/VirtualMachine.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "Compiler/Compiler.h"
+#include "Errors/RuntimeError.h"
+#include "Parser/Parser.h"
+#include "Resolver/Resolver.h"
+#include "Scanner/Scanner.h"
+
+namespace
+{
+    auto runBytecode(sail::VirtualMachine& machine, const std::string& source) -> std::string
+    {
+        using namespace sail;
+
+        std::vector<Token> tokens;
+        Scanner scanner {source, tokens};
+        scanner.scanTokens();
+
+        Parser parser {tokens};
+        std::vector<std::shared_ptr<Statement>> statements = parser.parse();
+
+        Selectors selectors;
+        Resolver resolver {selectors};
+        resolver.resolve(statements);
+
+        std::ostringstream output;
+        std::streambuf* previous = std::cout.rdbuf(output.rdbuf());
+
+        Compiler compiler {machine};
+        machine.interpret(compiler.compile(statements));
+
+        std::cout.rdbuf(previous);
+        return output.str();
+    }
+
+    auto runBytecode(const std::string& source) -> std::string
+    {
+        sail::VirtualMachine machine;
+        return runBytecode(machine, source);
+    }
+}  // namespace
+
+TEST_CASE("Arithmetic and strings", "[VirtualMachine]")
+{
+    REQUIRE(runBytecode("print(1 + 2 * 3);") == "7\n");
+    REQUIRE(runBytecode("print(\"a\" + \"b\");") == "ab\n");
+    REQUIRE(runBytecode("print(true + 1);") == "2\n");
+}
+
+TEST_CASE("Strings built at runtime are interned", "[VirtualMachine]")
+{
+    REQUIRE(runBytecode("print(\"ab\" == \"a\" + \"b\");") == "1\n");
+    REQUIRE(runBytecode("print(\"ab\" == \"a\" + \"c\");") == "0\n");
+}
+
+TEST_CASE("Closures capture variables", "[VirtualMachine]")
+{
+    const std::string source = R"(
+        fn makeCounter() { let i = 0; fn count() { i = i + 1; return i; } return count; }
+        let counter = makeCounter();
+        counter();
+        print(counter());
+    )";
+    REQUIRE(runBytecode(source) == "2\n");
+}
+
+TEST_CASE("Classes, initializers and super", "[VirtualMachine]")
+{
+    const std::string source = R"(
+        class A { init(x) { this.x = x; } get() { return this.x; } }
+        class B < A { init(x) { super.init(x * 2); } get() { return super.get() + 1; } }
+        print(B(5).get());
+    )";
+    REQUIRE(runBytecode(source) == "11\n");
+}
+
+TEST_CASE("Unreachable objects are collected", "[VirtualMachine]")
+{
+    sail::VirtualMachine machine;
+    const std::string source = R"(
+        class Node { init(next) { this.next = next; } }
+        let kept = Node(null);
+        for (let i = 0; i < 1000; i = i + 1) { Node(Node(null)); }
+    )";
+    runBytecode(machine, source);
+
+    sail::Heap& heap = machine.heap();
+    size_t before = heap.statistics().objectCount;
+    heap.collect();
+
+    REQUIRE(heap.statistics().collections > 0);
+    REQUIRE(heap.statistics().objectCount < before);
+    REQUIRE(heap.statistics().objectsFreed >= 2000);
+    REQUIRE(runBytecode(machine, "print(kept.next);") == "null\n");
+}
+
+TEST_CASE("Young objects stored in old objects survive minor collections", "[VirtualMachine]")
+{
+    sail::VirtualMachine machine;
+    runBytecode(machine, "class Box {} let box = Box();");
+
+    sail::Heap& heap = machine.heap();
+    heap.collect();
+    runBytecode(machine, R"(box.value = "young" + " string";)");
+    heap.collectNursery();
+
+    REQUIRE(heap.statistics().minorCollections > 0);
+    REQUIRE(runBytecode(machine, "print(box.value);") == "young string\n");
+}
+
+TEST_CASE("Young keys stored in old objects survive minor collections", "[VirtualMachine]")
+{
+    sail::VirtualMachine machine;
+    runBytecode(machine, "class Box {} let box = Box();");
+
+    sail::Heap& heap = machine.heap();
+    heap.collect();
+    // The name is only a constant of this script, which is gone once it has run.
+    runBytecode(machine, "box.brandNewField = 5;");
+    heap.collectNursery();
+
+    REQUIRE(runBytecode(machine, "print(box.brandNewField);") == "5\n");
+}
+
+TEST_CASE("Incremental collection keeps reachable objects", "[VirtualMachine]")
+{
+    sail::VirtualMachine machine;
+    sail::Heap& heap = machine.heap();
+    heap.setSliceBudget(std::chrono::microseconds(10));
+
+    const std::string source = R"(
+        class Node { init(value, next) { this.value = value; this.next = next; } }
+        let kept = null;
+        for (let i = 0; i < 30000; i = i + 1) { kept = Node(i, kept); Node(i, null); }
+        let count = 0;
+        while (kept != null) { count = count + 1; kept = kept.next; }
+        print(count);
+    )";
+
+    REQUIRE(runBytecode(machine, source) == "30000\n");
+    REQUIRE(heap.statistics().collections > 0);
+    REQUIRE(heap.statistics().pauses > heap.statistics().minorCollections);
+    REQUIRE(heap.statistics().maxPause >= heap.statistics().averagePause());
+}
+
+TEST_CASE("Superinstructions behave like the sequences they replace", "[VirtualMachine]")
+{
+    const std::string loops = R"(
+        fn run() {
+            let i = 0; let hits = 0; let s = "";
+            while (i < 6) {
+                if (i > 1 && i < 4) { hits = hits + 1; }
+                s = s + "x";
+                i = i + 1;
+            }
+            print(hits); print(s); print(i < 6);
+        }
+        run();
+    )";
+    REQUIRE(runBytecode(loops) == "2\nxxxxxx\n0\n");
+
+    REQUIRE(runBytecode("fn f() { let b = true; b = b + 1; print(b); } f();") == "2\n");
+}
+
+TEST_CASE("Compiled functions behave like interpreted ones", "[VirtualMachine]")
+{
+    sail::VirtualMachine machine;
+    machine.enableJit(1, 1);
+
+    const std::string source = R"(
+        fn fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); }
+        fn add(a, b) { return a + b; }
+        fn sum(n) { let s = 0; for (let i = 0; i < n; i = i + 1) { s = s + i; } return s; }
+        print(fib(15)); print(add(1, 2)); print(add("a", "b")); print(sum(10) <= 45);
+    )";
+    REQUIRE(runBytecode(machine, source) == "610\n3\nab\n1\n");
+    REQUIRE_THROWS_AS(runBytecode(machine, "add(1, \"b\");"), sail::RuntimeError);
+    REQUIRE(runBytecode(machine, "print(add(2, 3));") == "5\n");
+}
+
+TEST_CASE("Running loops switch to compiled code", "[VirtualMachine]")
+{
+    sail::VirtualMachine machine;
+    machine.enableJit(1000, 10);
+
+    const std::string source = R"(
+        class Box { init(x) { this.x = x; } }
+        let i = 0; let sum = 0;
+        while (i < 100) { let j = i; fn get() { return j; } sum = sum + Box(get()).x; i = i + 1; }
+        print(sum);
+    )";
+    REQUIRE(runBytecode(machine, source) == "4950\n");
+    const std::string failing = R"(while (i < 200) { i = i + 1; if (i > 150) i - "x"; })";
+    REQUIRE_THROWS_AS(runBytecode(machine, failing), sail::RuntimeError);
+}
+
+TEST_CASE("Calls nest up to the configured depth", "[VirtualMachine]")
+{
+    auto withDepth = [](const std::string& depth)
+    { return "fn d(n) { if (n == 0) return 0; return 1 + d(n - 1); } print(d(" + depth + "));"; };
+
+    sail::VirtualMachine machine {100000};
+    machine.enableJit(1, 1);
+    REQUIRE(runBytecode(machine, withDepth("99999")) == "99999\n");
+    REQUIRE_THROWS_AS(runBytecode(machine, withDepth("100000")), sail::RuntimeError);
+    REQUIRE(runBytecode(machine, withDepth("10")) == "10\n");
+
+    sail::VirtualMachine shallow {10};
+    REQUIRE_THROWS_AS(runBytecode(shallow, withDepth("10")), sail::RuntimeError);
+
+    // Reserving for this depth takes gigabytes of address space, but only the frames used cost
+    // memory.
+    sail::VirtualMachine deep {1000000};
+    REQUIRE(runBytecode(deep, withDepth("500000")) == "500000\n");
+}
+
+TEST_CASE("Calls in tail position reuse the caller's frame", "[VirtualMachine]")
+{
+    const std::string sources[] = {
+        "fn loop(i) { if (i > 0) loop(i - 1); } loop(1000000); print(loop(3));",
+        R"(fn isEven(n) { if (n == 0) return true; return isOdd(n - 1); }
+           fn isOdd(n) { if (n == 0) return false; return isEven(n - 1); }
+           print(isEven(100001));)",
+        R"(class A { init() { this.n = 0; }
+                     step(k) { if (k == 0) return this.n; this.n = this.n + 1;
+                               return this.step(k - 1); } }
+           print(A().step(10000));)",
+        R"(fn outer(n) { let a = n; fn get() { return a; } if (n == 0) return get;
+                        return outer(n - 1); }
+           print(outer(5)());)",
+        "fn last(n) { if (n == 0) return 7; last(n - 1); } print(last(3));",
+    };
+    const std::string expected[] = {"null\n", "0\n", "10000\n", "0\n", "null\n"};
+
+    for (size_t i = 0; i < std::size(sources); i++)
+    {
+        REQUIRE(runBytecode(sources[i]) == expected[i]);
+
+        sail::VirtualMachine machine;
+        machine.enableJit(1, 1);
+        REQUIRE(runBytecode(machine, sources[i]) == expected[i]);
+    }
+}
+
+// Hidden by default; run with "[benchmark]" under each threaded_dispatch setting to compare. The
+// loop is the one from tests/sail-lang/time.sail, which spends most of its time in dispatch.
+TEST_CASE("Dispatch overhead", "[.][benchmark][VirtualMachine]")
+{
+    const std::string source = R"(
+        fn a() {
+            let sum = 0;
+            for (let i = 0; i < 10000000; i = i + 1) {
+                if ((i / 2) > 500) { let b = i; sum = sum + b; }
+            }
+            return sum;
+        }
+        print(a());
+    )";
+
+    BENCHMARK("10M-iteration loop")
+    {
+        return runBytecode(source);
+    };
+}
@@ -8,6 +8,36 @@ set_languages("c++20")
 
 add_rules("plugin.vsxmake.autoupdate")
 
+option("nan_boxing")
+    set_default(true)
+    set_showmenu(true)
+    set_description("Encode bytecode VM values as NaN-boxed 64-bit words (requires 48-bit pointers)")
+option_end()
+
+option("threaded_dispatch")
+    set_default(true)
+    set_showmenu(true)
+    set_description("Dispatch bytecode with computed gotos instead of a switch (GCC and Clang only)")
+option_end()
+
+option("jit")
+    set_default(true)
+    set_showmenu(true)
+    set_description("Compile hot bytecode functions to machine code (x86-64 Linux with nan_boxing only)")
+option_end()
+
+option("dispatch_stats")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Count the bytecode instructions dispatched, reported by --dispatch-stats")
+option_end()
+
+option("stress_gc")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Run a full garbage collection before every allocation")
+option_end()
+
 target("SAIL_lib")
     set_kind("static")
 
@@ -17,10 +47,39 @@ target("SAIL_lib")
     
     add_packages("fmt", "magic_enum", "mimalloc", "unordered_dense")
 
+    if is_plat("linux") then
+        -- NativeStack queries the thread's stack bounds.
+        add_syslinks("pthread", {public = true})
+    end
+
     if is_mode("debug") then
         add_defines("SAIL_DEBUG")
     end
 
+    if has_config("nan_boxing") then
+        add_defines("SAIL_NAN_BOXING", {public = true})
+    end
+
+    if has_config("threaded_dispatch") then
+        add_defines("SAIL_THREADED_DISPATCH")
+        -- Otherwise GCC merges most of the per-opcode jumps back into a few shared ones.
+        add_files("src/VirtualMachine/VirtualMachine.cpp",
+                  {cxxflags = {"gcc::-fno-gcse", "gcc::-fno-crossjumping"}})
+    end
+
+    if has_config("jit") then
+        -- Public, as it changes the layout of the VirtualMachine.
+        add_defines("SAIL_JIT", {public = true})
+    end
+
+    if has_config("dispatch_stats") then
+        add_defines("SAIL_DISPATCH_STATS")
+    end
+
+    if has_config("stress_gc") then
+        add_defines("SAIL_STRESS_GC", {public = true})
+    end
+
     if is_kind("shared") then
         add_defines("SAIL_EXPORT=__declspec(dllexport)")
     else